@@ -8,4 +8,6 @@ Mutex<Ccf<{
     .rxBufSize = 256,
     .txBufSize = 256,
     .maxPktSize = 255,
+    .framing = Cobs::Variant::CCF_FRAMING,
+    .checksum = Checksum::Kind::CCF_CHECKSUM,
 }>> ccf;
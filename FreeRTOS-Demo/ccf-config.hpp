@@ -8,8 +8,20 @@
 
 #include <ccf.hpp>
 
+#if !defined(CCF_FRAMING)
+/// `Cobs::Variant` to use, set by the compare builds
+#define CCF_FRAMING Cobs
+#endif
+
+#if !defined(CCF_CHECKSUM)
+/// `Checksum::Kind` to use, set by the compare builds
+#define CCF_CHECKSUM Fnv1a
+#endif
+
 extern Mutex<Ccf<{
     .rxBufSize = 256,
     .txBufSize = 256,
     .maxPktSize = 255,
+    .framing = Cobs::Variant::CCF_FRAMING,
+    .checksum = Checksum::Kind::CCF_CHECKSUM,
 }>> ccf;
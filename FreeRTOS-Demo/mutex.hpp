@@ -1,6 +1,6 @@
 /**
 \file
-\brief Simple wrapper around the FreeRTOS mutex.
+\brief Simple wrapper around the FreeRTOS recursive mutex.
 */
 #pragma once
 
@@ -26,12 +26,12 @@ public:
     template<typename... Args>
     Mutex(Args && ... args) : value(std::forward<Args>(args)...)
     {
-        mutex = xSemaphoreCreateMutexStatic(&buffer);
+        mutex = xSemaphoreCreateRecursiveMutexStatic(&buffer);
     }
 
     std::optional<GuardT> lock(TickType_t timeout)
     {
-        if (xSemaphoreTake(mutex, timeout))
+        if (xSemaphoreTakeRecursive(mutex, timeout))
         {
             return std::optional{GuardT{this}};
         }
@@ -40,13 +40,13 @@ public:
 
     GuardT lock()
     {
-        while (!xSemaphoreTake(mutex, portMAX_DELAY)) { }
+        while (!xSemaphoreTakeRecursive(mutex, portMAX_DELAY)) { }
         return GuardT{this};
     }
 
     bool unlock() const
     {
-        return xSemaphoreGive(mutex) == pdTRUE;
+        return xSemaphoreGiveRecursive(mutex) == pdTRUE;
     }
 
     T & unsafeGetUnderlying()
@@ -25,7 +25,7 @@ static StaticTask_t commsCcfRpcTcb;
 TaskHandle_t rpcTask;
 
 /// Add RPC definitions here.
-static const Rpc rpc{
+static RPC_CONSTINIT const Rpc rpc{
 #if !defined(CCF_FEATURES) || CCF_FEATURES > 1
     /// Note: using `+` to convert lambda to a function pointer
     Call("version", "software version", {}, +[]() {
@@ -66,9 +66,10 @@ void commsCcfRpcTask(void *)
 {
     while (1)
     {
-        // Safety: Called from a single thread
+        // Locked as the response is written to the TX queue like logs.
+        // Recursive, so RPC functions can lock it again to log.
         // Poll first in case we skipped a notification on init
-        if (ccf.unsafeGetUnderlying().poll(rpc))
+        if (ccf.lock()->poll(rpc))
         {
             // Kick TX
             commsCcfTxAvailable();
@@ -0,0 +1,396 @@
+/**
+\file
+\brief Fields of aggregate structs, for encoding them without tuples.
+
+# Aggregate reflection
+
+C++ can't list the fields of a struct, but for aggregates (no
+constructors, base classes or private fields) it can be worked out:
+
+- The number of fields is the most values it can be brace initialised
+  with, using a placeholder `Any` that converts to any type. See
+  <https://github.com/Mizuchi/ForeachMember> for the idea.
+- Given the count, a structured binding with that many names gets
+  references to the fields, which `std::tie` makes into a tuple.
+
+The structured bindings have to be written out for each count, so this
+goes up to `maxFields`. C arrays as fields count as one field per
+element (brace elision), so use `std::array` instead.
+
+*/
+#pragma once
+
+#include <stddef.h>
+
+#include <concepts>
+#include <ranges>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace Aggregate
+{
+    constexpr size_t maxFields = 32;
+
+    /// Stands in for any field when counting them, never defined.
+    template<size_t>
+    struct Any
+    {
+        template<typename T>
+        operator T() const;
+    };
+
+    template<typename T, size_t... Index>
+    consteval bool initialisableWith(std::index_sequence<Index...>)
+    {
+        return requires { T{Any<Index>{}...}; };
+    }
+
+    /// The most values `T` can be brace initialised with.
+    template<typename T, size_t N = maxFields>
+    consteval size_t fieldCount()
+    {
+        if constexpr (N == 0 || initialisableWith<T>(std::make_index_sequence<N>{}))
+        {
+            return N;
+        }
+        else
+        {
+            return fieldCount<T, N - 1>();
+        }
+    }
+
+    /// Structs that can be encoded field by field. Ranges (e.g.
+    /// `std::array`) are aggregates too, but are encoded as such.
+    template<typename T>
+    concept Reflectable =
+        std::is_aggregate_v<T> && std::is_class_v<T> && !std::ranges::range<T>;
+
+    /// A tuple of references to the fields of `value`.
+    template<Reflectable T>
+    constexpr auto tie(T & value)
+    {
+        using U = std::remove_cv_t<T>;
+        static_assert(
+            !initialisableWith<U>(std::make_index_sequence<maxFields + 1>{}),
+            "Too many fields, see Aggregate::maxFields");
+        constexpr size_t N = fieldCount<U>();
+        if constexpr (N == 0)
+        {
+            return std::tie();
+        }
+        else if constexpr (N == 1)
+        {
+            auto & [f0] = value;
+            return std::tie(f0);
+        }
+        else if constexpr (N == 2)
+        {
+            auto & [f0, f1] = value;
+            return std::tie(f0, f1);
+        }
+        else if constexpr (N == 3)
+        {
+            auto & [f0, f1, f2] = value;
+            return std::tie(f0, f1, f2);
+        }
+        else if constexpr (N == 4)
+        {
+            auto & [f0, f1, f2, f3] = value;
+            return std::tie(f0, f1, f2, f3);
+        }
+        else if constexpr (N == 5)
+        {
+            auto & [f0, f1, f2, f3, f4] = value;
+            return std::tie(f0, f1, f2, f3, f4);
+        }
+        else if constexpr (N == 6)
+        {
+            auto & [f0, f1, f2, f3, f4, f5] = value;
+            return std::tie(f0, f1, f2, f3, f4, f5);
+        }
+        else if constexpr (N == 7)
+        {
+            auto & [f0, f1, f2, f3, f4, f5, f6] = value;
+            return std::tie(f0, f1, f2, f3, f4, f5, f6);
+        }
+        else if constexpr (N == 8)
+        {
+            auto & [f0, f1, f2, f3, f4, f5, f6, f7] = value;
+            return std::tie(f0, f1, f2, f3, f4, f5, f6, f7);
+        }
+        else if constexpr (N == 9)
+        {
+            auto & [
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8] = value;
+            return std::tie(
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8);
+        }
+        else if constexpr (N == 10)
+        {
+            auto & [
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9] = value;
+            return std::tie(
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9);
+        }
+        else if constexpr (N == 11)
+        {
+            auto & [
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10] = value;
+            return std::tie(
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10);
+        }
+        else if constexpr (N == 12)
+        {
+            auto & [
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11] = value;
+            return std::tie(
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11);
+        }
+        else if constexpr (N == 13)
+        {
+            auto & [
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12] = value;
+            return std::tie(
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12);
+        }
+        else if constexpr (N == 14)
+        {
+            auto & [
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13] = value;
+            return std::tie(
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13);
+        }
+        else if constexpr (N == 15)
+        {
+            auto & [
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14] = value;
+            return std::tie(
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14);
+        }
+        else if constexpr (N == 16)
+        {
+            auto & [
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15] = value;
+            return std::tie(
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15);
+        }
+        else if constexpr (N == 17)
+        {
+            auto & [
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15,
+                f16] = value;
+            return std::tie(
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15,
+                f16);
+        }
+        else if constexpr (N == 18)
+        {
+            auto & [
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15,
+                f16, f17] = value;
+            return std::tie(
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15,
+                f16, f17);
+        }
+        else if constexpr (N == 19)
+        {
+            auto & [
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15,
+                f16, f17, f18] = value;
+            return std::tie(
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15,
+                f16, f17, f18);
+        }
+        else if constexpr (N == 20)
+        {
+            auto & [
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15,
+                f16, f17, f18, f19] = value;
+            return std::tie(
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15,
+                f16, f17, f18, f19);
+        }
+        else if constexpr (N == 21)
+        {
+            auto & [
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15,
+                f16, f17, f18, f19, f20] = value;
+            return std::tie(
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15,
+                f16, f17, f18, f19, f20);
+        }
+        else if constexpr (N == 22)
+        {
+            auto & [
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15,
+                f16, f17, f18, f19, f20, f21] = value;
+            return std::tie(
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15,
+                f16, f17, f18, f19, f20, f21);
+        }
+        else if constexpr (N == 23)
+        {
+            auto & [
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15,
+                f16, f17, f18, f19, f20, f21, f22] = value;
+            return std::tie(
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15,
+                f16, f17, f18, f19, f20, f21, f22);
+        }
+        else if constexpr (N == 24)
+        {
+            auto & [
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15,
+                f16, f17, f18, f19, f20, f21, f22, f23] = value;
+            return std::tie(
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15,
+                f16, f17, f18, f19, f20, f21, f22, f23);
+        }
+        else if constexpr (N == 25)
+        {
+            auto & [
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15,
+                f16, f17, f18, f19, f20, f21, f22, f23,
+                f24] = value;
+            return std::tie(
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15,
+                f16, f17, f18, f19, f20, f21, f22, f23,
+                f24);
+        }
+        else if constexpr (N == 26)
+        {
+            auto & [
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15,
+                f16, f17, f18, f19, f20, f21, f22, f23,
+                f24, f25] = value;
+            return std::tie(
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15,
+                f16, f17, f18, f19, f20, f21, f22, f23,
+                f24, f25);
+        }
+        else if constexpr (N == 27)
+        {
+            auto & [
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15,
+                f16, f17, f18, f19, f20, f21, f22, f23,
+                f24, f25, f26] = value;
+            return std::tie(
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15,
+                f16, f17, f18, f19, f20, f21, f22, f23,
+                f24, f25, f26);
+        }
+        else if constexpr (N == 28)
+        {
+            auto & [
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15,
+                f16, f17, f18, f19, f20, f21, f22, f23,
+                f24, f25, f26, f27] = value;
+            return std::tie(
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15,
+                f16, f17, f18, f19, f20, f21, f22, f23,
+                f24, f25, f26, f27);
+        }
+        else if constexpr (N == 29)
+        {
+            auto & [
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15,
+                f16, f17, f18, f19, f20, f21, f22, f23,
+                f24, f25, f26, f27, f28] = value;
+            return std::tie(
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15,
+                f16, f17, f18, f19, f20, f21, f22, f23,
+                f24, f25, f26, f27, f28);
+        }
+        else if constexpr (N == 30)
+        {
+            auto & [
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15,
+                f16, f17, f18, f19, f20, f21, f22, f23,
+                f24, f25, f26, f27, f28, f29] = value;
+            return std::tie(
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15,
+                f16, f17, f18, f19, f20, f21, f22, f23,
+                f24, f25, f26, f27, f28, f29);
+        }
+        else if constexpr (N == 31)
+        {
+            auto & [
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15,
+                f16, f17, f18, f19, f20, f21, f22, f23,
+                f24, f25, f26, f27, f28, f29, f30] = value;
+            return std::tie(
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15,
+                f16, f17, f18, f19, f20, f21, f22, f23,
+                f24, f25, f26, f27, f28, f29, f30);
+        }
+        else if constexpr (N == 32)
+        {
+            auto & [
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15,
+                f16, f17, f18, f19, f20, f21, f22, f23,
+                f24, f25, f26, f27, f28, f29, f30, f31] = value;
+            return std::tie(
+                f0, f1, f2, f3, f4, f5, f6, f7,
+                f8, f9, f10, f11, f12, f13, f14, f15,
+                f16, f17, f18, f19, f20, f21, f22, f23,
+                f24, f25, f26, f27, f28, f29, f30, f31);
+        }
+    }
+
+    template<typename Tuple>
+    struct Values {};
+    template<typename... F>
+    struct Values<std::tuple<F &...>> { using Type = std::tuple<std::remove_cv_t<F>...>; };
+
+    /// The types of the fields of `T`, as a tuple.
+    template<Reflectable T>
+    using Fields = Values<decltype(tie(std::declval<T &>()))>::Type;
+};
@@ -25,6 +25,18 @@ bool Cbor::packEmbedded(Major major, uint8_t value, std::span<uint8_t> & buf)
     return false;
 }
 
+bool Cbor::packIndefinite(Major major, std::span<uint8_t> & buf)
+{
+    if (buf.size() >= 1)
+    {
+        buf[0] = initialByte(major, Minor::Indefinite);
+        debugf(DEBUG "pack indefinite %02X" END LOGLEVEL_ARGS, buf[0]);
+        buf = buf.subspan(1);
+        return true;
+    }
+    return false;
+}
+
 namespace
 {
     template<std::unsigned_integral Int>
@@ -170,6 +182,217 @@ std::optional<Cbor::Item> Cbor::unpack(std::span<uint8_t> & buf)
     return {};
 }
 
+std::optional<std::span<uint8_t>> Cbor::decodeContents(Major major, std::span<uint8_t> & buf)
+{
+    auto item = unpack32(buf);
+    if (!item || item->major != major)
+    {
+        return {};
+    }
+    if (item->minor == Minor::Indefinite)
+    {
+        debugf(WARN "Indefinite length strings aren't contiguous, not supported" END LOGLEVEL_ARGS);
+        return {};
+    }
+    if (item->value > buf.size())
+    {
+        debugf(WARN "String length %u past the end of the buffer (%zu)" END LOGLEVEL_ARGS,
+            static_cast<unsigned>(item->value), buf.size());
+        return {};
+    }
+    const auto contents = buf.first(static_cast<size_t>(item->value));
+    buf = buf.subspan(contents.size());
+    return {contents};
+}
+
+std::optional<Cbor::Item> Cbor::Reader::fail()
+{
+    error = true;
+    return {};
+}
+
+bool Cbor::Reader::push(Major major, size_t items, bool indefinite)
+{
+    if (size == stack.size())
+    {
+        debugf(WARN "Nested more than %zu deep" END LOGLEVEL_ARGS, stack.size());
+        return false;
+    }
+    stack[size++] = {items, major, indefinite};
+    return true;
+}
+
+void Cbor::Reader::finish()
+{
+    while (size > 0)
+    {
+        Frame & top = stack[size - 1];
+        if (top.indefinite)
+        {
+            ++top.remaining;
+            return;
+        }
+        if (--top.remaining > 0)
+        {
+            return;
+        }
+        --size;
+    }
+}
+
+std::optional<Cbor::Item> Cbor::Reader::next()
+{
+    lastContents = {};
+    if (error)
+    {
+        return {};
+    }
+    auto item = unpack(buf);
+    if (!item)
+    {
+        return fail();
+    }
+    Frame * top = size > 0 ? &stack[size - 1] : nullptr;
+    const bool indefinite = item->minor == Minor::Indefinite;
+
+    if (item->major == Major::Simple && indefinite)
+    {
+        if (top == nullptr || !top->indefinite ||
+            (top->major == Major::Map && top->remaining % 2 != 0))
+        {
+            debugf(WARN "Unexpected break" END LOGLEVEL_ARGS);
+            return fail();
+        }
+        --size;
+        finish();
+        return item;
+    }
+    // Chunks of an indefinite string are definite strings of the same type
+    if (top != nullptr && top->indefinite &&
+        (top->major == Major::Bytes || top->major == Major::Utf8) &&
+        (item->major != top->major || indefinite))
+    {
+        debugf(WARN "Bad chunk of an indefinite length string" END LOGLEVEL_ARGS);
+        return fail();
+    }
+
+    switch (item->major)
+    {
+        case Major::U64:
+        case Major::Neg64:
+            if (indefinite)
+            {
+                return fail();
+            }
+            finish();
+            return item;
+
+        case Major::Bytes:
+        case Major::Utf8:
+            if (indefinite)
+            {
+                return push(item->major, 0, true) ? item : fail();
+            }
+            if (item->value > buf.size())
+            {
+                debugf(WARN "String length past the end of the buffer" END LOGLEVEL_ARGS);
+                return fail();
+            }
+            lastContents = buf.first(static_cast<size_t>(item->value));
+            buf = buf.subspan(lastContents.size());
+            finish();
+            return item;
+
+        case Major::Array:
+        case Major::Map:
+        {
+            if (indefinite)
+            {
+                return push(item->major, 0, true) ? item : fail();
+            }
+            // Each item is at least a byte, so longer can't be well-formed
+            const uint64_t items = item->major == Major::Map ? 2 * item->value : item->value;
+            if (item->value > buf.size() || items > buf.size())
+            {
+                debugf(WARN "Length past the end of the buffer" END LOGLEVEL_ARGS);
+                return fail();
+            }
+            if (items == 0)
+            {
+                finish();
+                return item;
+            }
+            return push(item->major, static_cast<size_t>(items), false) ? item : fail();
+        }
+
+        case Major::Tagged:
+            if (indefinite)
+            {
+                return fail();
+            }
+            return push(item->major, 1, false) ? item : fail();
+
+        case Major::Simple:
+            // Two byte simple values below 32 aren't well-formed
+            if (item->minor == Minor::OneByteFollows && item->value < 32)
+            {
+                return fail();
+            }
+            finish();
+            return item;
+    }
+    return fail();
+}
+
+bool Cbor::Reader::skip()
+{
+    const size_t start = size;
+    do
+    {
+        if (!next())
+        {
+            return false;
+        }
+    } while (size > start);
+    return true;
+}
+
+bool Cbor::Reader::wellFormed(std::span<uint8_t> buf)
+{
+    Reader reader{buf};
+    return reader.skip() && reader.rest().empty();
+}
+
+bool Cbor::skipRest(Item32 header, size_t done, std::span<uint8_t> & buf)
+{
+    Reader extra{buf};
+    if (header.minor != Minor::Indefinite)
+    {
+        for (size_t i = done; i < header.value; ++i)
+        {
+            if (!extra.skip())
+            {
+                return false;
+            }
+        }
+        buf = extra.rest();
+        return true;
+    }
+    constexpr uint8_t breakByte = initialByte(Major::Simple, Minor::Indefinite);
+    while (!extra.rest().empty() && extra.rest()[0] != breakByte)
+    {
+        if (!extra.skip())
+        {
+            return false;
+        }
+    }
+    buf = extra.rest();
+    auto sentinel = unpack32(buf);
+    return sentinel.has_value() &&
+        sentinel->major == Major::Simple &&
+        sentinel->minor == Minor::Indefinite;
+}
+
 template<>
 bool Cbor::encode<unsigned char>(Major major, unsigned char value, std::span<uint8_t> & buf)
 {
@@ -209,3 +432,101 @@ bool Cbor::encode<unsigned long long>(Major major, unsigned long long value, std
         ? pack<unsigned long long>(major, value, buf)
         : encode<unsigned long>(major, static_cast<unsigned long>(value), buf);
 }
+
+namespace
+{
+    /// Decodes with `Cbor<T>`, so it is the same as the templated code.
+    template<typename T>
+    bool decodeAs(Cbor::Erased::Value & into, std::span<uint8_t> & buf)
+    {
+        const auto value = Cbor::Cbor<T>::decode(buf);
+        if (!value)
+        {
+            return false;
+        }
+        into = Cbor::Erased::wrap(*value);
+        return true;
+    }
+}
+
+bool Cbor::Erased::decode(Type type, Value & into, std::span<uint8_t> & buf)
+{
+    switch (type)
+    {
+        case Type::Undefined: return decodeAs<Undefined>(into, buf);
+        case Type::Bool: return decodeAs<bool>(into, buf);
+        case Type::U8: return decodeAs<uint8_t>(into, buf);
+        case Type::U16: return decodeAs<uint16_t>(into, buf);
+        case Type::U32: return decodeAs<uint32_t>(into, buf);
+        case Type::U64: return decodeAs<uint64_t>(into, buf);
+        case Type::I8: return decodeAs<int8_t>(into, buf);
+        case Type::I16: return decodeAs<int16_t>(into, buf);
+        case Type::I32: return decodeAs<int32_t>(into, buf);
+        case Type::I64: return decodeAs<int64_t>(into, buf);
+        case Type::Float: return decodeAs<float>(into, buf);
+        case Type::Double: return decodeAs<double>(into, buf);
+        case Type::Utf8: return decodeAs<std::string_view>(into, buf);
+        case Type::Bytes: return decodeAs<std::span<uint8_t>>(into, buf);
+    }
+    debugf(WARN "Unknown erased type %u" END LOGLEVEL_ARGS, static_cast<unsigned>(type));
+    return false;
+}
+
+bool Cbor::Erased::decodeArray(std::span<const Type> types, Value * into, std::span<uint8_t> & buf)
+{
+    auto header = unpack32(buf);
+    if (!header.has_value() || header->major != Major::Array ||
+        (header->minor != Minor::Indefinite && header->value < types.size()))
+    {
+        return false;
+    }
+    for (size_t i = 0; i < types.size(); ++i)
+    {
+        if (!decode(types[i], into[i], buf))
+        {
+            return false;
+        }
+    }
+    if (header->minor != Minor::Indefinite && header->value == types.size())
+    {
+        return true;
+    }
+    return skipRest(*header, types.size(), buf);
+}
+
+bool Cbor::Erased::encode(Type type, const Value & value, SinkRef & out)
+{
+    switch (type)
+    {
+        case Type::Undefined: return Cbor<void>::encode(Undefined{}, out);
+        case Type::Bool: return Cbor<bool>::encode(value.b, out);
+        case Type::U8: return Cbor<uint8_t>::encode(static_cast<uint8_t>(value.u), out);
+        case Type::U16: return Cbor<uint16_t>::encode(static_cast<uint16_t>(value.u), out);
+        case Type::U32: return Cbor<uint32_t>::encode(static_cast<uint32_t>(value.u), out);
+        case Type::U64: return Cbor<uint64_t>::encode(value.u, out);
+        case Type::I8: return Cbor<int8_t>::encode(static_cast<int8_t>(value.i), out);
+        case Type::I16: return Cbor<int16_t>::encode(static_cast<int16_t>(value.i), out);
+        case Type::I32: return Cbor<int32_t>::encode(static_cast<int32_t>(value.i), out);
+        case Type::I64: return Cbor<int64_t>::encode(value.i, out);
+        case Type::Float: return Cbor<float>::encode(value.f, out);
+        case Type::Double: return Cbor<double>::encode(value.d, out);
+        case Type::Utf8: return Cbor<std::string_view>::encode(value.str, out);
+        case Type::Bytes: return Cbor<std::span<uint8_t>>::encode(value.bytes, out);
+    }
+    debugf(WARN "Unknown erased type %u" END LOGLEVEL_ARGS, static_cast<unsigned>(type));
+    return false;
+}
+
+bool Cbor::Erased::call(
+    const Signature & signature,
+    void (*fn)(),
+    Value * values,
+    std::span<uint8_t> & args,
+    SinkRef & ret)
+{
+    if (!decodeArray(signature.args, values, args))
+    {
+        return false;
+    }
+    return encode(signature.ret, signature.invoke(fn, values), ret);
+}
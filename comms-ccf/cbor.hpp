@@ -61,7 +61,8 @@ And the value has the following forms (adapted from [RFC8949 table
 | 28-30/C/D/E | Reserved, not well-formed in the present document |
 | 31/0x1F     | Start/stop indefinite length values               |
 
-Floating-point values are either 16/32/64 bit values, the major 7
+Floating-point values are either 16/32/64 bit values (encoded in the
+smallest that holds them exactly, see [half floats](#half.hpp)), the major 7
 minor values 0-255 are simple values. Indefinite length values are
 strings/arrays/maps without a length known ahead of time. They are started
 by e.g. an array with minor value 31, and are ended with a simple/float
@@ -159,10 +160,10 @@ HTML that doesn't matter):
 | "\u00fc"                                                                                      | `3:2`  `C3BC`                                                      | Skip (not parsing escapes)        |
 | "\u6c34"                                                                                      | `3:3`  `E6B0B4`                                                    | Skip (not parsing escapes)        |
 | "\ud800\udd51"                                                                                | `3:4`  `F0908591`                                                  | Skip (not parsing escapes)        |
-| []                                                                                            | `4:0`  ``                                                          | std::span<int>                    |
-| [1, 2, 3]                                                                                     | `4:3`  `010203`                                                    | std::span<int>                    |
+| []                                                                                            | `4:0`  ``                                                          | ArrayView<int>                    |
+| [1, 2, 3]                                                                                     | `4:3`  `010203`                                                    | ArrayView<int>                    |
 | [1, [2, 3], [4, 5]]                                                                           | `4:3`  `01820203820405`                                            | tuple<int, span<int>, span<int>>  |
-| [1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25]   | `4:24` `190102030405060708090A0B0C0D0E 0F101112131415161718181819` | std::span<int>                    |
+| [1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25]   | `4:24` `190102030405060708090A0B0C0D0E 0F101112131415161718181819` | ArrayView<int>                    |
 | {}                                                                                            | `5:0`  ``                                                          | N/A                               |
 | {1: 2, 3: 4}                                                                                  | `5:2`  `01020304`                                                  | N/A                               |
 | {"a": 1, "b": [2, 3]}                                                                         | `5:2`  `6161016162820203`                                          | N/A                               |
@@ -184,6 +185,8 @@ HTML that doesn't matter):
 
 #pragma once
 
+#include "aggregate.hpp"
+#include "half.hpp"
 #include "types.hpp"
 
 #ifndef __STDC_WANT_IEC_60559_TYPES_EXT__
@@ -200,6 +203,7 @@ HTML that doesn't matter):
 #include <bit>
 #include <concepts>
 #include <optional>
+#include <ranges>
 #include <span>
 #include <string_view>
 #include <tuple>
@@ -217,6 +221,28 @@ namespace Cbor
 typedef _Float16 half;
 #endif
 
+    /// Bits of the half nearest to `value`, with `_Float16` if there is
+    /// one (it may be a single instruction), otherwise in software.
+    template<typename F> requires std::same_as<F, float> || std::same_as<F, double>
+    inline uint16_t toHalf(F value)
+    {
+#if defined(CBOR_HALF_SUPPORT)
+        return std::bit_cast<uint16_t>(static_cast<_Float16>(value));
+#else
+        return Half::fromFloat(value);
+#endif
+    }
+
+    /// The float equal to the half `bits`.
+    inline float fromHalf(uint16_t bits)
+    {
+#if defined(CBOR_HALF_SUPPORT)
+        return static_cast<float>(std::bit_cast<_Float16>(bits));
+#else
+        return Half::toFloat(bits);
+#endif
+    }
+
     /// Upper three bits of the initial/header byte
     enum class Major : uint8_t
     {
@@ -341,6 +367,9 @@ typedef _Float16 half;
 
     /// Pack a value [0, 23] embedded into the first header byte.
     bool packEmbedded(Major major, uint8_t value, std::span<uint8_t> & buf);
+    /// Pack the header byte starting an indefinite length item, or with
+    /// `Major::Simple` the "break" ending one.
+    bool packIndefinite(Major major, std::span<uint8_t> & buf);
     /// Pack an N bit value (usually if the value is [0, 23] you
     /// want packEmbedded).  Ends up as an initial header byte and
     /// ceil(N/8) value bytes
@@ -369,6 +398,376 @@ typedef _Float16 half;
     /// Unpack one item
     std::optional<Item> unpack(std::span<uint8_t> & buf);
 
+    /// Number of bytes following the initial byte for the given minor.
+    constexpr size_t argumentSize(Minor minor)
+    {
+        switch (minor)
+        {
+            case Minor::OneByteFollows: return 1;
+            case Minor::TwoByteFollows: return 2;
+            case Minor::FourByteFollows: return 4;
+            case Minor::EightByteFollows: return 8;
+            default: return 0;
+        }
+    }
+
+    /// A decoded item whose argument fits in 32 bits, see `unpack32`.
+    struct Item32
+    {
+        Major major;
+        Minor minor;
+        uint32_t value;
+    };
+
+    /// Argument bytes following each initial byte, by minor, with
+    /// `reservedArgument` for the minors 28 to 30, which aren't
+    /// well-formed.
+    constexpr uint8_t reservedArgument = 0xFF;
+    constexpr std::array<uint8_t, 32> argumentSizes = []()
+    {
+        std::array<uint8_t, 32> sizes{};
+        for (uint8_t minor = 0; minor < sizes.size(); ++minor)
+        {
+            sizes[minor] = static_cast<uint8_t>(argumentSize(static_cast<Minor>(minor)));
+        }
+        sizes[28] = sizes[29] = sizes[30] = reservedArgument;
+        return sizes;
+    }();
+
+    /// Loads a big endian integer from anywhere, e.g. unaligned in a
+    /// packet, as one load and byte swap where the target has them.
+    template<std::unsigned_integral U>
+    inline U loadBigEndian(const uint8_t * in)
+    {
+        U value;
+        memcpy(&value, in, sizeof(U));
+        if constexpr (std::endian::native == std::endian::little)
+        {
+            value = std::byteswap(value);
+        }
+        return value;
+    }
+
+    /// \brief Unpack one item whose argument is at most 32 bits.
+    ///
+    /// For everything but 64 bit integers and doubles, which would fail
+    /// on a bigger argument anyway. Avoids the 64 bit arithmetic of
+    /// `unpack`, which is several instructions per operation on 32 bit
+    /// targets such as Cortex-M.
+    inline std::optional<Item32> unpack32(std::span<uint8_t> & buf)
+    {
+        if (buf.empty())
+        {
+            return {};
+        }
+        const uint8_t initial = buf[0];
+        const Minor minor = getMinor(initial);
+        const size_t size = argumentSizes[static_cast<uint8_t>(minor)];
+        // Also rejects the reserved minors
+        if (size > sizeof(uint32_t) || buf.size() <= size)
+        {
+            return {};
+        }
+        uint32_t value;
+        switch (size)
+        {
+            case 0: value = static_cast<uint8_t>(minor); break;
+            case 1: value = buf[1]; break;
+            case 2: value = loadBigEndian<uint16_t>(&buf[1]); break;
+            default: value = loadBigEndian<uint32_t>(&buf[1]); break;
+        }
+        buf = buf.subspan(1 + size);
+        return {{getMajor(initial), minor, value}};
+    }
+
+    /// `unpack32` if an argument of `Bytes` fits, otherwise `unpack`.
+    template<size_t Bytes>
+    inline auto unpackFor(std::span<uint8_t> & buf)
+    {
+        if constexpr (Bytes <= sizeof(uint32_t))
+        {
+            return unpack32(buf);
+        }
+        else
+        {
+            return unpack(buf);
+        }
+    }
+
+    /// The minor of the smallest encoding of `value`.
+    constexpr Minor minorFor(uint64_t value)
+    {
+        return
+            value <= EMBEDDED_MAX ? static_cast<Minor>(value) :
+            value <= UINT8_MAX ? Minor::OneByteFollows :
+            value <= UINT16_MAX ? Minor::TwoByteFollows :
+            value <= UINT32_MAX ? Minor::FourByteFollows :
+            Minor::EightByteFollows;
+    }
+
+    /// Size of the smallest header holding `value`, e.g. an array length.
+    constexpr size_t headerSize(uint64_t value)
+    {
+        return 1 + argumentSize(minorFor(value));
+    }
+
+    /// \brief Encoding without bounds checks, for when the caller has
+    /// already checked for the worst case (see `Cbor<T>::maxSize`).
+    namespace Unchecked
+    {
+        /// Writes the item at `out`, returning the end of it.
+        constexpr uint8_t * pack(Item item, uint8_t * out)
+        {
+            *out++ = initialByte(item.major, item.minor);
+            for (size_t i = argumentSize(item.minor); i > 0; --i)
+            {
+                *out++ = static_cast<uint8_t>(item.value >> (8 * (i - 1)));
+            }
+            return out;
+        }
+
+        /// Writes `value` in its smallest encoding at `out`, returning the
+        /// end of it.
+        constexpr uint8_t * encode(Major major, uint64_t value, uint8_t * out)
+        {
+            return pack({major, minorFor(value), value}, out);
+        }
+    };
+
+    /// \brief Anything encoders can write to.
+    ///
+    /// That is `std::span<uint8_t>` (advanced past what is written, as for
+    /// decoding), or a class with the members
+    ///
+    ///     bool put(std::span<const uint8_t> bytes);  // All or nothing
+    ///     uint8_t * reserve(size_t size);
+    ///     void commit(size_t size);
+    ///
+    /// where `reserve` returns contiguous room for `size` bytes to write in
+    /// place, then `commit` keeps the first of them. It can return nullptr
+    /// (e.g. `CountingSink`, or at the end of a ring buffer) without `put`
+    /// failing, so encoders fall back to `put`.
+    template<typename S>
+    concept MemberSink = requires(S & sink, std::span<const uint8_t> bytes, size_t size)
+    {
+        { sink.put(bytes) } -> std::same_as<bool>;
+        { sink.reserve(size) } -> std::same_as<uint8_t *>;
+        sink.commit(size);
+    };
+
+    inline bool put(std::span<uint8_t> & buf, std::span<const uint8_t> bytes)
+    {
+        if (buf.size() < bytes.size())
+        {
+            return false;
+        }
+        std::copy(bytes.begin(), bytes.end(), buf.begin());
+        buf = buf.subspan(bytes.size());
+        return true;
+    }
+    inline uint8_t * reserve(std::span<uint8_t> & buf, size_t size)
+    {
+        return buf.size() < size ? nullptr : buf.data();
+    }
+    inline void commit(std::span<uint8_t> & buf, size_t size)
+    {
+        buf = buf.subspan(size);
+    }
+
+    template<MemberSink S>
+    bool put(S & sink, std::span<const uint8_t> bytes)
+    {
+        return sink.put(bytes);
+    }
+    template<MemberSink S>
+    uint8_t * reserve(S & sink, size_t size)
+    {
+        return sink.reserve(size);
+    }
+    template<MemberSink S>
+    void commit(S & sink, size_t size)
+    {
+        sink.commit(size);
+    }
+
+    template<typename S>
+    concept Sink = requires(S & sink, std::span<const uint8_t> bytes, size_t size)
+    {
+        { ::Cbor::put(sink, bytes) } -> std::same_as<bool>;
+        { ::Cbor::reserve(sink, size) } -> std::same_as<uint8_t *>;
+        ::Cbor::commit(sink, size);
+    };
+
+    /// \brief Counts the bytes encoded without writing them, e.g. for the
+    /// length of a definite length header before generating the data.
+    struct CountingSink
+    {
+        size_t count = 0;
+
+        bool put(std::span<const uint8_t> bytes)
+        {
+            count += bytes.size();
+            return true;
+        }
+        /// Never has room, as nothing is kept, so encoders use `put`.
+        uint8_t * reserve(size_t) { return nullptr; }
+        void commit(size_t size) { count += size; }
+    };
+
+    /// \brief A `Sink` of any type, e.g. to pass through non-templated
+    /// code such as an RPC vtable.
+    class SinkRef
+    {
+    public:
+        template<MemberSink S> requires (!std::same_as<S, SinkRef>)
+        SinkRef(S & sink)
+            : self(&sink)
+            , putFn([](void * target, std::span<const uint8_t> bytes)
+                { return static_cast<S *>(target)->put(bytes); })
+            , reserveFn([](void * target, size_t size)
+                { return static_cast<S *>(target)->reserve(size); })
+            , commitFn([](void * target, size_t size)
+                { static_cast<S *>(target)->commit(size); })
+        {
+        }
+        SinkRef(std::span<uint8_t> & buf)
+            : self(&buf)
+            , putFn([](void * target, std::span<const uint8_t> bytes)
+                { return ::Cbor::put(*static_cast<std::span<uint8_t> *>(target), bytes); })
+            , reserveFn([](void * target, size_t size)
+                { return ::Cbor::reserve(*static_cast<std::span<uint8_t> *>(target), size); })
+            , commitFn([](void * target, size_t size)
+                { ::Cbor::commit(*static_cast<std::span<uint8_t> *>(target), size); })
+        {
+        }
+
+        bool put(std::span<const uint8_t> bytes) { return putFn(self, bytes); }
+        uint8_t * reserve(size_t size) { return reserveFn(self, size); }
+        void commit(size_t size) { commitFn(self, size); }
+
+    private:
+        void * self;
+        bool (*putFn)(void *, std::span<const uint8_t>);
+        uint8_t * (*reserveFn)(void *, size_t);
+        void (*commitFn)(void *, size_t);
+    };
+
+    /// Packs the item after checking it fits.
+    template<Sink Out>
+    bool packItem(Item item, Out & out)
+    {
+        const size_t size = 1 + argumentSize(item.minor);
+        if (uint8_t * at = ::Cbor::reserve(out, size))
+        {
+            Unchecked::pack(item, at);
+            ::Cbor::commit(out, size);
+            return true;
+        }
+        std::array<uint8_t, 9> bytes;
+        Unchecked::pack(item, bytes.data());
+        return ::Cbor::put(out, std::span<const uint8_t>{bytes}.first(size));
+    }
+
+    /// Packs a header with `value` in its smallest encoding.
+    template<Sink Out>
+    bool encodeHeader(Major major, uint64_t value, Out & out)
+    {
+        return packItem({major, minorFor(value), value}, out);
+    }
+
+    template<Sink Out>
+    bool packEmbedded(Major major, uint8_t value, Out & out)
+    {
+        return value <= EMBEDDED_MAX && packItem({major, static_cast<Minor>(value), value}, out);
+    }
+
+    template<Sink Out>
+    bool packIndefinite(Major major, Out & out)
+    {
+        return packItem({major, Minor::Indefinite, 0}, out);
+    }
+
+    /// Unpack a definite length byte or text string of the given major
+    /// type, returning the contents (still in `buf`) and advancing `buf`
+    /// past them.
+    std::optional<std::span<uint8_t>> decodeContents(Major major, std::span<uint8_t> & buf);
+
+    /// Skips the elements after the first `done` of the array with
+    /// `header`, and the break if it is indefinite. Not inline, so the
+    /// `Reader` this uses isn't on the stack of callers that don't need it.
+    bool skipRest(Item32 header, size_t done, std::span<uint8_t> & buf);
+
+#if !defined(CBOR_MAX_DEPTH)
+/// Nesting `Cbor::Reader` can follow: arrays, maps, tags and indefinite
+/// length strings each take a level.
+#define CBOR_MAX_DEPTH 8
+#endif
+
+    /// \brief Pull parser for any well-formed CBOR, returning one item
+    /// header at a time, independent of the types it decodes to.
+    ///
+    /// Nesting is tracked in a fixed size stack rather than by recursion,
+    /// so untrusted input can't use up the call stack, and there is no
+    /// template code per type. Definite length strings are one item with
+    /// the contents in `contents()`, so skipping one is O(1); each item
+    /// inside an array, map or tag is visited once.
+    ///
+    /// E.g. ignoring unknown trailing arguments, checking a frame before
+    /// acting on any of it, or dumping a payload without knowing its type.
+    class Reader
+    {
+    public:
+        static constexpr size_t maxDepth = CBOR_MAX_DEPTH;
+
+        explicit Reader(std::span<uint8_t> buf_) : buf(buf_) {}
+
+        /// \brief The next item header, in order.
+        ///
+        /// Arrays, maps and tags are followed by their contents, and
+        /// indefinite length items by their elements (chunks for strings)
+        /// ending in the "break", `Major::Simple` with `Minor::Indefinite`.
+        /// Fails at the end of the buffer or if the input isn't
+        /// well-formed, after which it keeps failing.
+        std::optional<Item> next();
+
+        /// Skips the whole of the next item, including everything nested
+        /// inside it.
+        bool skip();
+
+        /// Contents of the definite length string `next` just returned.
+        std::span<uint8_t> contents() const { return lastContents; }
+        /// Number of arrays, maps, tags and indefinite strings the next
+        /// item is inside.
+        size_t depth() const { return size; }
+        /// Unread input, e.g. after the last item.
+        std::span<uint8_t> rest() const { return buf; }
+        bool failed() const { return error; }
+
+        /// Whether `buf` is exactly one well-formed item.
+        static bool wellFormed(std::span<uint8_t> buf);
+
+    private:
+        struct Frame
+        {
+            /// Items left, or for indefinite lengths the items so far
+            size_t remaining;
+            Major major;
+            bool indefinite;
+        };
+
+        bool push(Major major, size_t items, bool indefinite);
+        /// Counts a finished item against the enclosing ones, popping
+        /// those it finishes.
+        void finish();
+        std::optional<Item> fail();
+
+        std::span<uint8_t> buf;
+        std::span<uint8_t> lastContents;
+        std::array<Frame, maxDepth> stack{};
+        size_t size = 0;
+        bool error = false;
+    };
+
     /// Encodes a value that can be up to N bits. Unlike \see pack<T>,
     /// it uses the smallest encoding.
     template<std::unsigned_integral Int>
@@ -388,9 +787,26 @@ typedef _Float16 half;
     ///
     /// Valid data which can be encoded has the following methods:
     ///
-    ///     static bool encode(T value, std::span<uint8_t> & buf);
+    ///     template<Sink Out>
+    ///     static bool encode(T value, Out & buf);
     ///     static std::optional<T> decode(std::span<uint8_t> & buf);
-    ///     static size_t maxSize();
+    ///
+    /// encoding to any `Sink`, usually a `std::span<uint8_t>`.
+    ///
+    /// Types with a bound on their encoded size (not strings, bytes or
+    /// ranges, unless fixed size) also have
+    ///
+    ///     static constexpr size_t maxSize();
+    ///     static uint8_t * encodeUnchecked(T value, uint8_t * out);
+    ///
+    /// so that containers of them can check for the worst case once, then
+    /// encode without checking each item. Containers (tuples and
+    /// aggregates) can also decode into existing storage,
+    ///
+    ///     static bool decodeInto(T & into, std::span<uint8_t> & buf);
+    ///
+    /// so their elements aren't decoded into a copy first (see
+    /// `Cbor::decodeInto`).
     ///
     /// Though C++ doesn't require this and in fact is better at giving
     /// compile-errors (rather than link errors) if it is commented out, as then
@@ -400,21 +816,74 @@ typedef _Float16 half;
     {
     };
 
+    /// Types with a compile time bound on their encoded size.
+    template<typename T>
+    concept Bounded = requires
+    {
+        typename std::integral_constant<size_t, Cbor<T>::maxSize()>;
+    };
+
+    /// If `out` has contiguous room for the worst case of `T`, encodes
+    /// `value` with no more bounds checks and returns true.
+    template<Bounded T, typename V, Sink Out>
+    bool encodeIfRoom(const V & value, Out & out)
+    {
+        uint8_t * at = ::Cbor::reserve(out, Cbor<T>::maxSize());
+        if (at == nullptr)
+        {
+            return false;
+        }
+        const uint8_t * end = Cbor<T>::encodeUnchecked(value, at);
+        ::Cbor::commit(out, static_cast<size_t>(end - at));
+        return true;
+    }
+
+    /// Decodes into `into`, in place for containers, otherwise assigning
+    /// the decoded value. Leaves `into` partly decoded on failure.
+    template<typename T>
+    bool decodeInto(T & into, std::span<uint8_t> & buf)
+    {
+        if constexpr (requires { Cbor<T>::decodeInto(into, buf); })
+        {
+            return Cbor<T>::decodeInto(into, buf);
+        }
+        else
+        {
+            auto decoded = Cbor<T>::decode(buf);
+            if (!decoded)
+            {
+                return false;
+            }
+            into = std::move(*decoded);
+            return true;
+        }
+    }
+
     template<typename I> requires std::integral<I> && (!std::same_as<I, bool>)
     struct Cbor<I>
     {
         static constexpr size_t bytes = sizeof(I);
-        static bool encode(I value, std::span<uint8_t> & buf)
+        static constexpr Item item(I value)
         {
             Major major = value >= 0 ? Major::U64 : Major::Neg64;
             /// Note, in 2s complement -n-1 is bitwise negated n (~n)
             value = value >= 0 ? value : ~value;
             using UI = std::make_unsigned_t<I>;
-            return ::Cbor::encode<UI>(major, std::bit_cast<UI>(value), buf);
+            const uint64_t magnitude = std::bit_cast<UI>(value);
+            return {major, minorFor(magnitude), magnitude};
+        }
+        template<Sink Out>
+        static bool encode(I value, Out & buf)
+        {
+            return packItem(item(value), buf);
+        }
+        static uint8_t * encodeUnchecked(I value, uint8_t * out)
+        {
+            return Unchecked::pack(item(value), out);
         }
         static std::optional<I> decode(std::span<uint8_t> & buf)
         {
-            auto value = unpack(buf);
+            auto value = unpackFor<bytes>(buf);
             if (!value)
             {
                 return {};
@@ -434,7 +903,7 @@ typedef _Float16 half;
             }
             return {};
         }
-        static size_t maxSize()
+        static constexpr size_t maxSize()
         {
             return 1 + bytes;
         }
@@ -448,50 +917,49 @@ typedef _Float16 half;
     {
         static constexpr size_t bytes = sizeof(F);
         using BitT = UintT<bytes * 8>;
-        static bool encode(F value, std::span<uint8_t> & buf)
+        /// The smallest float that holds `value` exactly.
+        static Item item(F value)
         {
-#if defined(CBOR_HALF_SUPPORT)
             if (std::isnan(value))
             {
-                const auto nan = std::bit_cast<uint16_t>(static_cast<_Float16>(NAN));
-                return ::Cbor::pack<uint16_t>(Major::Float, nan, buf);
-            }
-            const auto v16 = static_cast<_Float16>(value);
-            if (value == v16)
-            {
-                uint16_t b16 = std::bit_cast<uint16_t>(v16);
-                return ::Cbor::pack<uint16_t>(Major::Float, b16, buf);
-            }
-#endif
-            if (std::isnan(value))
-            {
-                const auto nan = std::bit_cast<uint32_t>(static_cast<float>(NAN));
-                return ::Cbor::pack<uint32_t>(Major::Float, nan, buf);
+                return {Major::Float, Minor::TwoByteFollows, Half::quietNan};
             }
             const auto v32 = static_cast<float>(value);
             if (v32 == value)
             {
+                const uint16_t b16 = toHalf(v32);
+                if (fromHalf(b16) == v32)
+                {
+                    return {Major::Float, Minor::TwoByteFollows, b16};
+                }
                 const auto b32 = std::bit_cast<uint32_t>(v32);
-                return ::Cbor::pack<uint32_t>(Major::Float, b32, buf);
+                return {Major::Float, Minor::FourByteFollows, b32};
             }
             const auto v64 = static_cast<double>(value);
             const auto b64 = std::bit_cast<uint64_t>(v64);
-            return ::Cbor::pack<uint64_t>(Major::Float, b64, buf);
+            return {Major::Float, Minor::EightByteFollows, b64};
+        }
+        template<Sink Out>
+        static bool encode(F value, Out & buf)
+        {
+            return packItem(item(value), buf);
+        }
+        static uint8_t * encodeUnchecked(F value, uint8_t * out)
+        {
+            return Unchecked::pack(item(value), out);
         }
         static std::optional<F> decode(std::span<uint8_t> & buf)
         {
-            auto value = unpack(buf);
+            auto value = unpackFor<bytes>(buf);
             if (!value || value->major != Major::Float)
             {
                 return {};
             }
             // Allow upcasts to support deterministically encoded CBOR
-#if defined(CBOR_HALF_SUPPORT)
             if (value->minor == Minor::TwoByteFollows && 2 <= bytes)
             {
-                return {static_cast<F>(std::bit_cast<_Float16>(static_cast<uint16_t>(value->value)))};
+                return {static_cast<F>(fromHalf(static_cast<uint16_t>(value->value)))};
             }
-#endif
             if (value->minor == Minor::FourByteFollows && 4 <= bytes)
             {
                 return {static_cast<F>(std::bit_cast<float>(static_cast<uint32_t>(value->value)))};
@@ -502,25 +970,74 @@ typedef _Float16 half;
             }
             return {};
         }
-        static size_t maxSize()
+        static constexpr size_t maxSize()
         {
-            return 1 + bytes;
+            // Up to double, as long double isn't encoded any bigger
+            return 1 + std::min<size_t>(bytes, 8);
+        }
+    };
+
+    /// \brief A float to always encode as the nearest half float, e.g. for
+    /// sensor readings where 3 significant digits are plenty.
+    ///
+    /// Each is 3 bytes rather than 5 (or 9), but lossy: values round to
+    /// the nearest half, beyond 65504 to infinity, and lose precision below
+    /// 6.1e-5 down to zero at 3e-8. Decodes any float width, like `F`.
+    template<typename F> requires std::same_as<F, float> || std::same_as<F, double>
+    struct AsHalf
+    {
+        F value;
+    };
+
+    template<typename F> requires std::same_as<F, float> || std::same_as<F, double>
+    struct Cbor<AsHalf<F>>
+    {
+        static Item item(AsHalf<F> reading)
+        {
+            const uint16_t b16 = std::isnan(reading.value) ? Half::quietNan : toHalf(reading.value);
+            return {Major::Float, Minor::TwoByteFollows, b16};
+        }
+        template<Sink Out>
+        static bool encode(AsHalf<F> reading, Out & buf)
+        {
+            return packItem(item(reading), buf);
+        }
+        static uint8_t * encodeUnchecked(AsHalf<F> reading, uint8_t * out)
+        {
+            return Unchecked::pack(item(reading), out);
+        }
+        static std::optional<AsHalf<F>> decode(std::span<uint8_t> & buf)
+        {
+            const auto value = Cbor<F>::decode(buf);
+            if (!value)
+            {
+                return {};
+            }
+            return {AsHalf<F>{*value}};
         }
+        static constexpr size_t maxSize() { return 3; }
     };
 
     template<>
     struct Cbor<bool>
     {
-        static bool encode(bool value, std::span<uint8_t> & buf)
+        template<Sink Out>
+        static bool encode(bool value, Out & buf)
         {
             return packEmbedded(
                 Major::Simple,
                 static_cast<uint8_t>(value ? SimpleValues::True : SimpleValues::False),
                 buf);
         }
+        static constexpr size_t maxSize() { return 1; }
+        static uint8_t * encodeUnchecked(bool value, uint8_t * out)
+        {
+            *out = initialByte(Major::Simple, static_cast<Minor>(value ? SimpleValues::True : SimpleValues::False));
+            return out + 1;
+        }
         static std::optional<bool> decode(std::span<uint8_t> & buf)
         {
-            auto value = unpack(buf);
+            auto value = unpack32(buf);
             if (value.has_value() && value->major == Major::Simple)
             {
                 if (value->minor == static_cast<Minor>(SimpleValues::True))
@@ -539,27 +1056,48 @@ typedef _Float16 half;
     template<typename T>
     struct Cbor<T *>
     {
-        static bool encode(T * obj, std::span<uint8_t> & buf)
+        template<Sink Out>
+        static bool encode(T * obj, Out & buf)
         {
             return obj != nullptr
                 ? Cbor<T>::encode(*obj, buf)
                 : packEmbedded(Major::Simple, static_cast<uint8_t>(SimpleValues::Null), buf);
         }
+        static constexpr size_t maxSize() requires Bounded<T>
+        {
+            return std::max<size_t>(1, Cbor<T>::maxSize());
+        }
+        static uint8_t * encodeUnchecked(T * obj, uint8_t * out) requires Bounded<T>
+        {
+            if (obj != nullptr)
+            {
+                return Cbor<T>::encodeUnchecked(*obj, out);
+            }
+            *out = initialByte(Major::Simple, static_cast<Minor>(SimpleValues::Null));
+            return out + 1;
+        }
     };
 
     template<>
     struct Cbor<void>
     {
-        static bool encode(Undefined, std::span<uint8_t> & buf)
+        template<Sink Out>
+        static bool encode(Undefined, Out & buf)
         {
             return packEmbedded(
                 Major::Simple,
                 static_cast<uint8_t>(SimpleValues::Undefined), buf);
         }
+        static constexpr size_t maxSize() { return 1; }
+        static uint8_t * encodeUnchecked(Undefined, uint8_t * out)
+        {
+            *out = initialByte(Major::Simple, static_cast<Minor>(SimpleValues::Undefined));
+            return out + 1;
+        }
 
         static std::optional<Undefined> decode(std::span<uint8_t> & buf)
         {
-            auto value = unpack(buf);
+            auto value = unpack32(buf);
             if (value.has_value() &&
                 value->major == Major::Simple &&
                 value->minor == static_cast<Minor>(SimpleValues::Undefined))
@@ -573,67 +1111,45 @@ typedef _Float16 half;
     template<>
     struct Cbor<std::string_view>
     {
-        static bool encode(std::string_view str, std::span<uint8_t> & buf)
+        template<Sink Out>
+        static bool encode(std::string_view str, Out & buf)
         {
-            if (!::Cbor::encode<size_t>(Major::Utf8, str.size(), buf))
+            if (!encodeHeader(Major::Utf8, str.size(), buf))
             {
                 return false;
             }
-            for (char c : str)
+            return ::Cbor::put(buf, std::span{reinterpret_cast<const uint8_t *>(str.data()), str.size()});
+        }
+        /// Decodes to a view of the string in `buf`, without copying, so
+        /// it is only valid while `buf` is.
+        static std::optional<std::string_view> decode(std::span<uint8_t> & buf)
+        {
+            const auto contents = decodeContents(Major::Utf8, buf);
+            if (!contents)
             {
-                if (buf.size() == 0)
-                {
-                    return false;
-                }
-                buf[0] = c;
-                buf = buf.subspan(1);
+                return {};
             }
-            return true;
+            return {std::string_view{reinterpret_cast<const char *>(contents->data()), contents->size()}};
         }
     };
 
     template<>
     struct Cbor<const char *>
     {
-        static bool encode(const char * str, std::span<uint8_t> & buf)
+        template<Sink Out>
+        static bool encode(const char * str, Out & buf)
         {
-            const size_t size = strlen(str);
-            if (!::Cbor::encode<size_t>(Major::Utf8, size, buf))
-            {
-                return false;
-            }
-            for (size_t i = 0; i < size; ++i)
-            {
-                if (buf.size() == 0)
-                {
-                    return false;
-                }
-                buf[0] = str[i];
-                buf = buf.subspan(1);
-            }
-            return true;
+            return Cbor<std::string_view>::encode(std::string_view{str}, buf);
         }
     };
 
     template<size_t size>
     struct Cbor<const char (&)[size]>
     {
-        static bool encode(const char (&str)[size], std::span<uint8_t> & buf)
+        template<Sink Out>
+        static bool encode(const char (&str)[size], Out & buf)
         {
-            if (!::Cbor::encode<size_t>(Major::Utf8, size, buf))
-            {
-                return false;
-            }
-            for (size_t i = 0; i < size; ++i)
-            {
-                if (buf.size() == 0)
-                {
-                    return false;
-                }
-                buf[0] = str[i];
-                buf = buf.subspan(1);
-            }
-            return true;
+            return Cbor<std::string_view>::encode(std::string_view{str, size}, buf);
         }
     };
 
@@ -641,14 +1157,18 @@ typedef _Float16 half;
     struct Cbor<std::tuple<Item...>>
     {
         using Tuple = std::tuple<Item...>;
-        static bool encode(Tuple tup, std::span<uint8_t> & buf)
+        template<Sink Out>
+        static bool encode(Tuple tup, Out & buf)
         {
-            if (buf.size() < 1)
+            if constexpr (Bounded<Tuple>)
             {
-                return false;
+                if (encodeIfRoom<Tuple>(tup, buf))
+                {
+                    return true;
+                }
             }
             return
-                ::Cbor::encode<size_t>(
+                encodeHeader(
                     Major::Array,
                     std::tuple_size_v<Tuple>,
                     buf) &&
@@ -660,174 +1180,975 @@ typedef _Float16 half;
                     );
                 }(std::index_sequence_for<Item...>{});
         }
-        template<typename... T>
-        static std::optional<std::tuple<T...>> transpose(std::tuple<std::optional<T>...> ts)
+        static constexpr size_t maxSize() requires (Bounded<Item> && ...)
         {
-            return [&]<size_t... Index>(std::index_sequence<Index...>)
-            {
-                if ((std::get<Index>(ts) && ...))
-                {
-                    return std::optional<std::tuple<T...>>{std::in_place, *std::get<Index>(ts)...};
-                }
-                return std::optional<std::tuple<T...>>{};
-            }(std::index_sequence_for<T...>{});
+            return headerSize(sizeof...(Item)) + (Cbor<Item>::maxSize() + ... + 0);
+        }
+        static uint8_t * encodeUnchecked(const Tuple & tup, uint8_t * out) requires (Bounded<Item> && ...)
+        {
+            out = Unchecked::encode(Major::Array, sizeof...(Item), out);
+            [&]<size_t... Index>(std::index_sequence<Index...>)
+            {
+                ((out = Cbor<Item>::encodeUnchecked(std::get<Index>(tup), out)), ...);
+            }(std::index_sequence_for<Item...>{});
+            return out;
+        }
+        /// \brief Decodes the elements straight into `tup`, stopping at the
+        /// first that fails, and ignores any after them (e.g. arguments
+        /// added by a newer caller).
+        ///
+        /// E.g. RPC arguments, so there is only the one copy of them.
+        static bool decodeInto(Tuple & tup, std::span<uint8_t> & buf)
+        {
+            auto value = unpack32(buf);
+            if (!value.has_value() || value->major != Major::Array ||
+                (value->minor != Minor::Indefinite && value->value < sizeof...(Item)))
+            {
+                return false;
+            }
+            const bool ok = [&]<size_t... Index>(std::index_sequence<Index...>)
+            {
+                return (::Cbor::decodeInto(std::get<Index>(tup), buf) && ...);
+            }(std::index_sequence_for<Item...>{});
+            if (!ok)
+            {
+                return false;
+            }
+            if (value->minor != Minor::Indefinite && value->value == sizeof...(Item))
+            {
+                return true;
+            }
+            return skipRest(*value, sizeof...(Item), buf);
         }
         static std::optional<Tuple> decode(std::span<uint8_t> & buf)
         {
-            auto value = unpack(buf);
-            if (value.has_value() && value->major == Major::Array)
+            std::optional<Tuple> tup{std::in_place};
+            if (!decodeInto(*tup, buf))
+            {
+                return {};
+            }
+            return tup;
+        }
+    };
+
+    template<size_t Size>
+    struct Cbor<std::span<uint8_t, Size>>
+    {
+        template<Sink Out>
+        static bool encode(std::span<uint8_t, Size> span, Out & buf)
+        {
+            if (!encodeHeader(Major::Bytes, span.size(), buf))
+            {
+                return false;
+            }
+            return ::Cbor::put(buf, span);
+        }
+        /// Decodes to a view of the bytes in `buf`, without copying, so
+        /// it is only valid while `buf` is.
+        static std::optional<std::span<uint8_t, Size>> decode(std::span<uint8_t> & buf)
+        {
+            const auto contents = decodeContents(Major::Bytes, buf);
+            if (!contents || (Size != std::dynamic_extent && contents->size() != Size))
+            {
+                return {};
+            }
+            return {std::span<uint8_t, Size>{contents->data(), contents->size()}};
+        }
+        static constexpr size_t maxSize() requires (Size != std::dynamic_extent)
+        {
+            return headerSize(Size) + Size;
+        }
+        static uint8_t * encodeUnchecked(std::span<uint8_t, Size> span, uint8_t * out)
+            requires (Size != std::dynamic_extent)
+        {
+            out = Unchecked::encode(Major::Bytes, Size, out);
+            return std::copy(span.begin(), span.end(), out);
+        }
+    };
+
+    template<typename T, size_t Size>
+    struct Cbor<std::array<T, Size>>
+    {
+        template<Sink Out>
+        static bool encode(const std::array<T, Size> & array, Out & buf)
+        {
+            if constexpr (Bounded<T>)
+            {
+                if (encodeIfRoom<std::array<T, Size>>(array, buf))
+                {
+                    return true;
+                }
+            }
+            if (!encodeHeader(Major::Array, array.size(), buf))
+            {
+                return false;
+            }
+            for (const auto & item : array)
             {
-                std::tuple<std::optional<Item>...> ts{Cbor<Item>::decode(buf)...};
-                if (value->minor != Minor::Indefinite)
+                if (!Cbor<T>::encode(item, buf))
                 {
-                    return transpose(ts);
+                    return false;
                 }
-                else
+            }
+            return true;
+        }
+        static constexpr size_t maxSize() requires Bounded<T>
+        {
+            return headerSize(Size) + Size * Cbor<T>::maxSize();
+        }
+        static uint8_t * encodeUnchecked(const std::array<T, Size> & array, uint8_t * out)
+            requires Bounded<T>
+        {
+            out = Unchecked::encode(Major::Array, Size, out);
+            for (const auto & item : array)
+            {
+                out = Cbor<T>::encodeUnchecked(item, out);
+            }
+            return out;
+        }
+        /// \brief Decodes the elements straight into `array`, stopping at
+        /// the first that fails. The array must have exactly `Size`
+        /// elements.
+        static bool decodeInto(std::array<T, Size> & array, std::span<uint8_t> & buf)
+        {
+            auto value = unpack32(buf);
+            if (!value.has_value() || value->major != Major::Array ||
+                (value->minor != Minor::Indefinite && value->value != Size))
+            {
+                return false;
+            }
+            for (auto & item : array)
+            {
+                if (!::Cbor::decodeInto(item, buf))
                 {
-                    auto sentinel = unpack(buf);
-                    if (sentinel.has_value() &&
-                        sentinel->major == Major::Simple &&
-                        sentinel->minor == Minor::Indefinite)
+                    return false;
+                }
+            }
+            if (value->minor != Minor::Indefinite)
+            {
+                return true;
+            }
+            auto sentinel = unpack32(buf);
+            return sentinel.has_value() &&
+                sentinel->major == Major::Simple &&
+                sentinel->minor == Minor::Indefinite;
+        }
+        static std::optional<std::array<T, Size>> decode(std::span<uint8_t> & buf)
+        {
+            std::optional<std::array<T, Size>> array{std::in_place};
+            if (!decodeInto(*array, buf))
+            {
+                return {};
+            }
+            return array;
+        }
+    };
+
+    /// \brief A CBOR array of `T`, left in the buffer it was decoded from
+    /// and only decoded an element at a time by the iterator.
+    ///
+    /// Unlike `std::array<T, Size>` the length isn't fixed, and the
+    /// elements are never all on the stack at once, so e.g. an RPC can
+    /// take any number of register addresses in constant stack. Decoding
+    /// checks the header and each element up front, so iterating can't
+    /// fail. Like the other views, it is only valid while the buffer is.
+    template<typename T>
+    class ArrayView : public std::ranges::view_interface<ArrayView<T>>
+    {
+    public:
+        class Iterator
+        {
+        public:
+            using value_type = T;
+            using difference_type = ptrdiff_t;
+
+            Iterator() = default;
+            Iterator(std::span<uint8_t> pos_, size_t remaining_)
+                : pos(pos_), remaining(remaining_)
+            {
+            }
+
+            T operator*() const
+            {
+                auto next = pos;
+                return *Cbor<T>::decode(next);
+            }
+            Iterator & operator++()
+            {
+                Cbor<T>::decode(pos);
+                --remaining;
+                return *this;
+            }
+            Iterator operator++(int)
+            {
+                auto old = *this;
+                ++*this;
+                return old;
+            }
+            bool operator==(const Iterator & other) const
+            {
+                return remaining == other.remaining;
+            }
+
+        private:
+            std::span<uint8_t> pos;
+            size_t remaining = 0;
+        };
+
+        ArrayView() = default;
+        /// The `count` elements encoded in `items`, without the header.
+        ArrayView(std::span<uint8_t> items_, size_t count_)
+            : items(items_), count(count_)
+        {
+        }
+
+        Iterator begin() const { return {items, count}; }
+        Iterator end() const { return {items.last(0), 0}; }
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        /// The encoded elements, without the array header.
+        std::span<uint8_t> encoded() const { return items; }
+
+    private:
+        std::span<uint8_t> items;
+        size_t count = 0;
+    };
+
+    template<typename T>
+    struct Cbor<ArrayView<T>>
+    {
+        /// Always uses a definite length, copying the encoded elements.
+        template<Sink Out>
+        static bool encode(ArrayView<T> view, Out & buf)
+        {
+            if (!encodeHeader(Major::Array, view.size(), buf))
+            {
+                return false;
+            }
+            const auto items = view.encoded();
+            return ::Cbor::put(buf, items);
+        }
+        static std::optional<ArrayView<T>> decode(std::span<uint8_t> & buf)
+        {
+            auto value = unpack32(buf);
+            if (!value.has_value() || value->major != Major::Array)
+            {
+                return {};
+            }
+            const auto start = buf;
+            size_t count = 0;
+            if (value->minor != Minor::Indefinite)
+            {
+                // Each element is at least a byte, so a bogus length runs
+                // out of buffer rather than looping for long
+                for (; count < value->value; ++count)
+                {
+                    if (!Cbor<T>::decode(buf))
                     {
-                        return transpose(ts);
+                        return {};
                     }
                 }
+                return {ArrayView<T>{start.first(start.size() - buf.size()), count}};
             }
-            return {};
+            constexpr uint8_t sentinel = initialByte(Major::Simple, Minor::Indefinite);
+            for (; buf.size() >= 1 && buf[0] != sentinel; ++count)
+            {
+                if (!Cbor<T>::decode(buf))
+                {
+                    return {};
+                }
+            }
+            if (buf.size() < 1)
+            {
+                return {};
+            }
+            const auto items = start.first(start.size() - buf.size());
+            buf = buf.subspan(1);
+            return {ArrayView<T>{items, count}};
         }
     };
 
-    template<size_t Size>
-    struct Cbor<std::span<uint8_t, Size>>
+    /// Element types of RFC 8746 typed arrays
+    template<typename T>
+    concept TypedArrayElement =
+        (std::integral<T> && !std::same_as<T, bool> && sizeof(T) <= 8) ||
+#if defined(CBOR_HALF_SUPPORT)
+        std::same_as<T, _Float16> ||
+#endif
+        std::same_as<T, float> || std::same_as<T, double>;
+
+    /// \brief An [RFC 8746](https://www.rfc-editor.org/rfc/rfc8746.html)
+    /// typed array: fixed width numbers as one byte string, tagged with
+    /// their type and byte order (tags 64 to 87).
+    ///
+    /// Unlike `std::array` or `ArrayView` (each number encoded on its own),
+    /// encoding is a single copy, and the size on the wire is known from
+    /// the number of elements, e.g. for blocks of ADC samples. It is sent
+    /// in the native byte order (tagged as such), decoding accepts either,
+    /// swapping bytes as the iterator reads each element. Like the other
+    /// views, it is only valid while the buffer (or values) it views is.
+    template<TypedArrayElement T, size_t Extent = std::dynamic_extent>
+    class TypedArray : public std::ranges::view_interface<TypedArray<T, Extent>>
     {
-        static bool encode(std::span<uint8_t, Size> span, std::span<uint8_t> & buf)
+    public:
+        /// The tag for `T` in the given byte order.
+        static constexpr uint64_t tag(std::endian order)
         {
-            if (buf.size() < 1)
+            constexpr bool floating = !std::integral<T>;
+            // Floats start at 16 bits, and single bytes have no order
+            constexpr size_t log2Size = std::bit_width(sizeof(T)) - 1 - (floating ? 1 : 0);
+            const bool little = sizeof(T) > 1 && order == std::endian::little;
+            return
+                64 |
+                (floating ? 1 << 4 : 0) |
+                (!floating && std::is_signed_v<T> ? 1 << 3 : 0) |
+                (little ? 1 << 2 : 0) |
+                log2Size;
+        }
+
+        class Iterator
+        {
+        public:
+            using value_type = T;
+            using difference_type = ptrdiff_t;
+
+            Iterator() = default;
+            Iterator(const uint8_t * pos_, bool swap_) : pos(pos_), swap(swap_) {}
+
+            T operator*() const
             {
-                return false;
+                std::array<uint8_t, sizeof(T)> raw;
+                memcpy(raw.data(), pos, sizeof(T));
+                if (swap)
+                {
+                    std::reverse(raw.begin(), raw.end());
+                }
+                return std::bit_cast<T>(raw);
             }
-            if (!::Cbor::encode<size_t>(Major::Bytes, span.size(), buf))
+            Iterator & operator++()
             {
-                return false;
+                pos += sizeof(T);
+                return *this;
+            }
+            Iterator operator++(int)
+            {
+                auto old = *this;
+                ++*this;
+                return old;
             }
-            if (buf.size() < span.size())
+            bool operator==(const Iterator & other) const { return pos == other.pos; }
+
+        private:
+            const uint8_t * pos = nullptr;
+            bool swap = false;
+        };
+
+        TypedArray() = default;
+        /// Views `values` in memory, to encode them.
+        TypedArray(std::span<const T, Extent> values)
+            : bytes(reinterpret_cast<const uint8_t *>(values.data()), values.size_bytes()),
+              order(std::endian::native)
+        {
+        }
+        /// Views encoded elements in the given byte order.
+        TypedArray(std::span<const uint8_t> bytes_, std::endian order_)
+            : bytes(bytes_), order(order_)
+        {
+        }
+
+        Iterator begin() const { return {bytes.data(), swapped()}; }
+        Iterator end() const { return {bytes.data() + bytes.size(), swapped()}; }
+        size_t size() const { return bytes.size() / sizeof(T); }
+        /// The elements as they are encoded.
+        std::span<const uint8_t> encoded() const { return bytes; }
+        std::endian byteOrder() const { return order; }
+
+    private:
+        bool swapped() const { return sizeof(T) > 1 && order != std::endian::native; }
+
+        std::span<const uint8_t> bytes;
+        std::endian order = std::endian::native;
+    };
+
+    template<TypedArrayElement T, size_t Extent>
+    struct Cbor<TypedArray<T, Extent>>
+    {
+        using View = TypedArray<T, Extent>;
+        template<Sink Out>
+        static bool encode(View view, Out & buf)
+        {
+            const auto bytes = view.encoded();
+            if (!encodeHeader(Major::Tagged, View::tag(view.byteOrder()), buf) ||
+                !encodeHeader(Major::Bytes, bytes.size(), buf))
             {
                 return false;
             }
-            std::copy(span.cbegin(), span.cend(), buf.begin());
-            buf = buf.subspan(span.size());
-            return true;
+            return ::Cbor::put(buf, bytes);
         }
-        static std::optional<std::span<uint8_t, Size>> decode(std::span<uint8_t> & buf)
+        static constexpr size_t maxSize() requires (Extent != std::dynamic_extent)
+        {
+            return headerSize(View::tag(std::endian::native)) +
+                headerSize(Extent * sizeof(T)) + Extent * sizeof(T);
+        }
+        static uint8_t * encodeUnchecked(View view, uint8_t * out)
+            requires (Extent != std::dynamic_extent)
         {
-            auto value = unpack(buf);
-            if (value.has_value() && value->major == Major::Bytes)
+            const auto bytes = view.encoded();
+            out = Unchecked::encode(Major::Tagged, View::tag(view.byteOrder()), out);
+            out = Unchecked::encode(Major::Bytes, bytes.size(), out);
+            return std::copy(bytes.begin(), bytes.end(), out);
+        }
+        static std::optional<View> decode(std::span<uint8_t> & buf)
+        {
+            auto tag = unpack32(buf);
+            if (!tag.has_value() || tag->major != Major::Tagged)
+            {
+                return {};
+            }
+            // Tag 68 is bytes clamped to 0-255 when converting to them
+            constexpr uint64_t clamped = 68;
+            std::endian order;
+            if (tag->value == View::tag(std::endian::little) ||
+                (std::same_as<T, uint8_t> && tag->value == clamped))
+            {
+                order = std::endian::little;
+            }
+            else if (tag->value == View::tag(std::endian::big))
+            {
+                order = std::endian::big;
+            }
+            else
+            {
+                return {};
+            }
+            const auto contents = decodeContents(Major::Bytes, buf);
+            if (!contents ||
+                contents->size() % sizeof(T) != 0 ||
+                (Extent != std::dynamic_extent && contents->size() != Extent * sizeof(T)))
             {
-                if (value->minor == Minor::Indefinite)
+                return {};
+            }
+            return {View{*contents, order}};
+        }
+    };
+
+    /// \brief LEB128 varints (seven bits a byte, least significant first,
+    /// top bit set on all but the last byte) and zigzag encoding (0, -1,
+    /// 1, -2, ... as 0, 1, 2, 3, ...) so small negatives are small too.
+    namespace Varint
+    {
+        constexpr size_t maxSize = 10;
+
+        constexpr uint64_t zigzag(int64_t value)
+        {
+            return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+        }
+        constexpr int64_t unzigzag(uint64_t value)
+        {
+            return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+        }
+
+        constexpr size_t size(uint64_t value)
+        {
+            return value == 0 ? 1 : (std::bit_width(value) + 6) / 7;
+        }
+
+        /// Writes `value` at `out`, which must have room for `size(value)`
+        /// bytes, returning the end.
+        constexpr uint8_t * write(uint64_t value, uint8_t * out)
+        {
+            while (value >= 0x80)
+            {
+                *out++ = static_cast<uint8_t>(value | 0x80);
+                value >>= 7;
+            }
+            *out++ = static_cast<uint8_t>(value);
+            return out;
+        }
+
+        /// Reads a varint from the start of `buf`, failing if it is
+        /// truncated or doesn't fit 64 bits.
+        constexpr std::optional<uint64_t> read(std::span<const uint8_t> & buf)
+        {
+            uint64_t value = 0;
+            for (size_t i = 0; i < buf.size() && i < maxSize; ++i)
+            {
+                const uint64_t bits = buf[i] & 0x7F;
+                if (i == maxSize - 1 && bits > 1)
                 {
                     return {};
                 }
-                else
+                value |= bits << (7 * i);
+                if ((buf[i] & 0x80) == 0)
                 {
-                    return {buf};
+                    buf = buf.subspan(i + 1);
+                    return value;
                 }
             }
             return {};
         }
     };
 
-    template<typename T, size_t Size>
-    struct Cbor<std::array<T, Size>>
+    /// Tag of `Deltas`/`DeltaView`, from the first come first served range
+    /// of the [IANA registry](https://www.iana.org/assignments/cbor-tags)
+    /// but not registered.
+    constexpr uint64_t deltaTag = 0xCCF0;
+
+    /// \brief Integers to encode as the first value followed by the
+    /// differences between them, zigzag encoded varints in a tagged byte
+    /// string (see `deltaTag`).
+    ///
+    /// For slowly changing values such as timestamps, counters or sensor
+    /// readings, where the differences often fit in a byte rather than
+    /// the 3-5 of each full integer. Decode with `DeltaView`.
+    template<std::integral I> requires (!std::same_as<I, bool>)
+    struct Deltas
+    {
+        std::span<const I> values;
+    };
+
+    /// \brief Decoded `Deltas`, left in the packet and reconstructed an
+    /// element at a time by the iterator.
+    ///
+    /// Decoding checks every varint and that each value fits in `I`, so
+    /// iterating can't fail. Like the other views, it is only valid while
+    /// the buffer is.
+    template<std::integral I> requires (!std::same_as<I, bool>)
+    class DeltaView : public std::ranges::view_interface<DeltaView<I>>
     {
-        static bool encode(std::array<T, Size> array, std::span<uint8_t> & buf)
+    public:
+        class Iterator
         {
-            if (buf.size() < 1)
+        public:
+            using value_type = I;
+            using difference_type = ptrdiff_t;
+
+            Iterator() = default;
+            Iterator(std::span<const uint8_t> rest_, size_t remaining_)
+                : rest(rest_), remaining(remaining_)
+            {
+                next();
+            }
+
+            I operator*() const { return static_cast<I>(value); }
+            Iterator & operator++()
+            {
+                --remaining;
+                next();
+                return *this;
+            }
+            Iterator operator++(int)
+            {
+                auto old = *this;
+                ++*this;
+                return old;
+            }
+            bool operator==(const Iterator & other) const
+            {
+                return remaining == other.remaining;
+            }
+
+        private:
+            void next()
+            {
+                if (remaining > 0)
+                {
+                    value += static_cast<uint64_t>(Varint::unzigzag(*Varint::read(rest)));
+                }
+            }
+
+            std::span<const uint8_t> rest;
+            /// Wraps like the differences on the encoding side
+            uint64_t value = 0;
+            size_t remaining = 0;
+        };
+
+        DeltaView() = default;
+        /// The `count` varints in `bytes`.
+        DeltaView(std::span<const uint8_t> bytes_, size_t count_)
+            : bytes(bytes_), count(count_)
+        {
+        }
+
+        Iterator begin() const { return {bytes, count}; }
+        Iterator end() const { return {{}, 0}; }
+        size_t size() const { return count; }
+        /// The varints, without the tag and byte string header.
+        std::span<const uint8_t> encoded() const { return bytes; }
+
+    private:
+        std::span<const uint8_t> bytes;
+        size_t count = 0;
+    };
+
+    template<std::integral I> requires (!std::same_as<I, bool>)
+    struct Cbor<Deltas<I>>
+    {
+        /// The difference from `prev` to `value`, wrapping so that it
+        /// round trips for any 64 bit values.
+        static constexpr uint64_t delta(I value, uint64_t prev)
+        {
+            return Varint::zigzag(static_cast<int64_t>(static_cast<uint64_t>(value) - prev));
+        }
+        template<Sink Out>
+        static bool encode(Deltas<I> deltas, Out & buf)
+        {
+            size_t size = 0;
+            uint64_t prev = 0;
+            for (const I value : deltas.values)
+            {
+                size += Varint::size(delta(value, prev));
+                prev = static_cast<uint64_t>(value);
+            }
+            if (!encodeHeader(Major::Tagged, deltaTag, buf) ||
+                !encodeHeader(Major::Bytes, size, buf))
             {
                 return false;
             }
-            if (!::Cbor::encode<size_t>(Major::Array, array.size(), buf))
+            prev = 0;
+            if (uint8_t * out = ::Cbor::reserve(buf, size))
+            {
+                for (const I value : deltas.values)
+                {
+                    out = Varint::write(delta(value, prev), out);
+                    prev = static_cast<uint64_t>(value);
+                }
+                ::Cbor::commit(buf, size);
+                return true;
+            }
+            // No contiguous room (e.g. wrapping a ring buffer), a varint at a time
+            for (const I value : deltas.values)
+            {
+                std::array<uint8_t, Varint::maxSize> bytes;
+                const uint8_t * end = Varint::write(delta(value, prev), bytes.data());
+                if (!::Cbor::put(buf, std::span<const uint8_t>{bytes.data(), end}))
+                {
+                    return false;
+                }
+                prev = static_cast<uint64_t>(value);
+            }
+            return true;
+        }
+    };
+
+    template<std::integral I> requires (!std::same_as<I, bool>)
+    struct Cbor<DeltaView<I>>
+    {
+        /// Copies the varints back out.
+        template<Sink Out>
+        static bool encode(DeltaView<I> view, Out & buf)
+        {
+            const auto bytes = view.encoded();
+            if (!encodeHeader(Major::Tagged, deltaTag, buf) ||
+                !encodeHeader(Major::Bytes, bytes.size(), buf))
             {
                 return false;
             }
-            for (const auto & item : array)
+            return ::Cbor::put(buf, bytes);
+        }
+        static std::optional<DeltaView<I>> decode(std::span<uint8_t> & buf)
+        {
+            auto tag = unpack32(buf);
+            if (!tag.has_value() || tag->major != Major::Tagged || tag->value != deltaTag)
+            {
+                return {};
+            }
+            const auto contents = decodeContents(Major::Bytes, buf);
+            if (!contents)
+            {
+                return {};
+            }
+            std::span<const uint8_t> rest{*contents};
+            uint64_t value = 0;
+            size_t count = 0;
+            for (; !rest.empty(); ++count)
+            {
+                const auto delta = Varint::read(rest);
+                if (!delta)
+                {
+                    return {};
+                }
+                value += static_cast<uint64_t>(Varint::unzigzag(*delta));
+                // Must round trip through I, e.g. not negative if unsigned
+                const bool fits = std::is_signed_v<I>
+                    ? std::in_range<I>(static_cast<int64_t>(value))
+                    : std::in_range<I>(value);
+                if (!fits)
+                {
+                    return {};
+                }
+            }
+            return {DeltaView<I>{*contents, count}};
+        }
+    };
+
+    /// \brief Any other range, e.g. a filtered or transformed view,
+    /// encoded as an array straight from its source.
+    ///
+    /// Sized ranges get a definite length, others (e.g.
+    /// `std::views::filter`) the indefinite length form, as they can't be
+    /// counted without iterating twice. Ranges of `char` are left out, so
+    /// text isn't sent as an array of numbers by accident.
+    template<std::ranges::input_range R>
+        requires (!std::same_as<std::ranges::range_value_t<R>, char>)
+    struct Cbor<R>
+    {
+        using T = std::ranges::range_value_t<R>;
+        template<Sink Out>
+        static bool encode(R range, Out & buf)
+        {
+            if constexpr (std::ranges::sized_range<R>)
+            {
+                if (!encodeHeader(Major::Array, std::ranges::size(range), buf))
+                {
+                    return false;
+                }
+            }
+            else if (!packIndefinite(Major::Array, buf))
+            {
+                return false;
+            }
+            for (auto && item : range)
             {
                 if (!Cbor<T>::encode(item, buf))
                 {
                     return false;
                 }
             }
+            if constexpr (!std::ranges::sized_range<R>)
+            {
+                return packIndefinite(Major::Simple, buf);
+            }
             return true;
         }
-        static std::optional<std::array<T, Size>> decode(std::span<uint8_t> & buf)
+    };
+
+    /// Specialise as true to encode the aggregate `T` as a map from field
+    /// index to value, rather than an array, e.g.
+    ///
+    ///     namespace Cbor { template<> constexpr bool aggregateAsMap<Config> = true; }
+    ///
+    /// It is bigger, but fields missing when decoding keep their default
+    /// value, so fields can be added without breaking older clients.
+    template<typename T>
+    constexpr bool aggregateAsMap = false;
+
+    /// \brief Aggregate structs, field by field (see
+    /// [aggregate.hpp](#aggregate.hpp)), as a definite length array or
+    /// with `aggregateAsMap` a map.
+    ///
+    /// Decoding needs the fields to be default constructible, as they are
+    /// decoded straight into the struct.
+    template<Aggregate::Reflectable T>
+    struct Cbor<T>
+    {
+        static constexpr size_t fields = Aggregate::fieldCount<T>();
+        static constexpr Major major = aggregateAsMap<T> ? Major::Map : Major::Array;
+
+        template<Sink Out>
+        static bool encode(const T & value, Out & buf)
         {
-            auto value = unpack(buf);
-            if (value.has_value() && value->major == Major::Array)
+            if constexpr (Bounded<T>)
             {
-                std::array<T, Size> array =
-                    [&]<size_t... Index>(std::index_sequence<Index...>)
-                    {
-                        return std::array<T, Size>{
-                            *((void)Index, Cbor<T>::decode(buf))...
-                        };
-                    }(std::make_index_sequence<Size>{});
-                if (value->minor != Minor::Indefinite)
+                if (encodeIfRoom<T>(value, buf))
                 {
-                    return array;
+                    return true;
                 }
-                else
+            }
+            const auto refs = Aggregate::tie(value);
+            return
+                encodeHeader(major, fields, buf) &&
+                [&]<size_t... Index>(std::index_sequence<Index...>)
                 {
-                    auto sentinel = unpack(buf);
-                    if (sentinel.has_value() &&
-                        sentinel->major == Major::Simple &&
-                        sentinel->minor == Minor::Indefinite)
+                    return (encodeField<Index>(std::get<Index>(refs), buf) && ...);
+                }(std::make_index_sequence<fields>{});
+        }
+        static std::optional<T> decode(std::span<uint8_t> & buf)
+        {
+            std::optional<T> value{std::in_place};
+            if (!decodeInto(*value, buf))
+            {
+                return {};
+            }
+            return value;
+        }
+        /// Decodes over the fields of `value`, so fields missing from a
+        /// map keep their value.
+        static bool decodeInto(T & value, std::span<uint8_t> & buf)
+        {
+            auto header = unpack32(buf);
+            if (!header.has_value() || header->major != major)
+            {
+                return false;
+            }
+            auto refs = Aggregate::tie(value);
+            const bool indefinite = header->minor == Minor::Indefinite;
+            if constexpr (!aggregateAsMap<T>)
+            {
+                if (!indefinite && header->value != fields)
+                {
+                    return false;
+                }
+                const bool ok = [&]<size_t... Index>(std::index_sequence<Index...>)
+                {
+                    return (::Cbor::decodeInto(std::get<Index>(refs), buf) && ...);
+                }(std::make_index_sequence<fields>{});
+                return ok && (!indefinite || decodeBreak(buf));
+            }
+            else
+            {
+                for (uint64_t i = 0; indefinite || i < header->value; ++i)
+                {
+                    if (indefinite && decodeBreak(buf))
+                    {
+                        break;
+                    }
+                    const auto key = Cbor<size_t>::decode(buf);
+                    if (!key || *key >= fields)
                     {
-                        return array;
+                        return false;
+                    }
+                    const bool ok = [&]<size_t... Index>(std::index_sequence<Index...>)
+                    {
+                        return ((*key != Index || ::Cbor::decodeInto(std::get<Index>(refs), buf)) && ...);
+                    }(std::make_index_sequence<fields>{});
+                    if (!ok)
+                    {
+                        return false;
                     }
                 }
+                return true;
             }
-            return {};
+        }
+
+        static constexpr size_t maxSize() requires Bounded<Aggregate::Fields<T>>
+        {
+            return [&]<size_t... Index>(std::index_sequence<Index...>)
+            {
+                return headerSize(fields) + (
+                    (
+                        (aggregateAsMap<T> ? headerSize(Index) : 0) +
+                        Cbor<std::tuple_element_t<Index, Aggregate::Fields<T>>>::maxSize()
+                    ) + ... + 0
+                );
+            }(std::make_index_sequence<fields>{});
+        }
+        static uint8_t * encodeUnchecked(const T & value, uint8_t * out)
+            requires Bounded<Aggregate::Fields<T>>
+        {
+            const auto refs = Aggregate::tie(value);
+            out = Unchecked::encode(major, fields, out);
+            [&]<size_t... Index>(std::index_sequence<Index...>)
+            {
+                (
+                    (
+                        out = aggregateAsMap<T> ? Unchecked::encode(Major::U64, Index, out) : out,
+                        out = Cbor<std::remove_cvref_t<std::tuple_element_t<Index, decltype(refs)>>>
+                            ::encodeUnchecked(std::get<Index>(refs), out)
+                    ), ...
+                );
+            }(std::make_index_sequence<fields>{});
+            return out;
+        }
+
+    private:
+        template<size_t Index, typename F, Sink Out>
+        static bool encodeField(const F & field, Out & buf)
+        {
+            if constexpr (aggregateAsMap<T>)
+            {
+                if (!encodeHeader(Major::U64, Index, buf))
+                {
+                    return false;
+                }
+            }
+            return Cbor<F>::encode(field, buf);
+        }
+        /// Consumes the break ending an indefinite length item, if next.
+        static bool decodeBreak(std::span<uint8_t> & buf)
+        {
+            if (buf.size() >= 1 && buf[0] == initialByte(Major::Simple, Minor::Indefinite))
+            {
+                buf = buf.subspan(1);
+                return true;
+            }
+            return false;
         }
     };
 
-    template<Major major>
+    /// Bytes `value` encodes to, without encoding it anywhere.
+    template<typename T>
+    size_t encodedSize(const T & value)
+    {
+        CountingSink counter;
+        Cbor<T>::encode(value, counter);
+        return counter.count;
+    }
+
+    /// \brief Encodes an array or map element by element, with a definite
+    /// length header if the number of elements is given, otherwise the
+    /// indefinite length form.
+    ///
+    /// For a definite length when the elements are only known once
+    /// generated, generate them twice, first into a `CountingSink` for
+    /// the `count()`, e.g.
+    ///
+    ///     Cbor::CountingSink counter;
+    ///     size_t count;
+    ///     {
+    ///         Cbor::Sequence<Cbor::Major::Array, Cbor::CountingSink> seq(counter);
+    ///         generate(seq);
+    ///         count = seq.count();
+    ///     }
+    ///     Cbor::Sequence<Cbor::Major::Array> seq(buf, count);
+    ///     generate(seq);
+    template<Major major, Sink Out = std::span<uint8_t>>
     class Sequence
     {
+        template<Major, Sink>
+        friend class Sequence;
+
     public:
-        Sequence(std::span<uint8_t> & buf_, size_t extent_ = std::dynamic_extent)
+        Sequence(Out & buf_, size_t extent_ = std::dynamic_extent)
             : buf(buf_),  extent(extent_)
         {
             if (extent == std::dynamic_extent)
             {
-                packEmbedded(major, static_cast<uint8_t>(Minor::Indefinite), buf);
+                packIndefinite(major, buf);
             }
             else
             {
-                ::Cbor::encode<size_t>(major, extent, buf);
+                encodeHeader(major, extent, buf);
             }
         }
         template<Major parentMajor>
-        Sequence(Sequence<parentMajor> & parentSeq, size_t extent_ = std::dynamic_extent)
+        Sequence(Sequence<parentMajor, Out> & parentSeq, size_t extent_ = std::dynamic_extent)
             : buf(parentSeq.buf),  extent(extent_)
         {
             ++parentSeq.packed;
             if (extent == std::dynamic_extent)
             {
-                packEmbedded(major, static_cast<uint8_t>(Minor::Indefinite), buf);
+                packIndefinite(major, buf);
             }
             else
             {
-                ::Cbor::encode<size_t>(major, extent, buf);
+                encodeHeader(major, extent, buf);
             }
         }
         bool as_expected()
         {
             return extent == std::dynamic_extent || extent == packed;
         }
+        /// Elements encoded so far (including nested sequences).
+        size_t count() const
+        {
+            return packed;
+        }
         ~Sequence()
         {
             if (extent == std::dynamic_extent)
             {
-                packEmbedded(Major::Simple, static_cast<uint8_t>(Minor::Indefinite), buf);
+                packIndefinite(Major::Simple, buf);
             }
         }
 
@@ -838,8 +2159,135 @@ typedef _Float16 half;
             return Cbor<T>::encode(value, buf);
         }
     private:
-        std::span<uint8_t> & buf;
+        Out & buf;
         const size_t extent;
         size_t packed = 0;
     };
+    /// \brief Type-erased encoding and decoding of the simple types,
+    /// described by a byte each, so code that handles many signatures
+    /// (e.g. RPC with `RPC_TYPE_TABLES`) shares one copy of the CBOR code
+    /// in cbor.cpp rather than instantiating it per signature.
+    ///
+    /// Values are held in a `Value` union, only the member for the type
+    /// is valid. The encoding is the same as `Cbor<T>`.
+    namespace Erased
+    {
+        enum class Type : uint8_t
+        {
+            /// Nothing decoded, encodes as undefined (e.g. void returns)
+            Undefined,
+            Bool,
+            U8, U16, U32, U64,
+            I8, I16, I32, I64,
+            Float,
+            Double,
+            /// `std::string_view`
+            Utf8,
+            /// `std::span<uint8_t>`
+            Bytes,
+        };
+
+        union Value
+        {
+            constexpr Value() : u(0) { }
+
+            uint64_t u;
+            int64_t i;
+            float f;
+            double d;
+            bool b;
+            std::string_view str;
+            std::span<uint8_t> bytes;
+        };
+
+        /// The `Type` of `T`, if it has one.
+        template<typename T>
+        struct Describe { };
+
+        template<>
+        struct Describe<bool> { static constexpr Type type = Type::Bool; };
+        template<>
+        struct Describe<Undefined> { static constexpr Type type = Type::Undefined; };
+        template<>
+        struct Describe<float> { static constexpr Type type = Type::Float; };
+        template<>
+        struct Describe<double> { static constexpr Type type = Type::Double; };
+        template<>
+        struct Describe<std::string_view> { static constexpr Type type = Type::Utf8; };
+        template<>
+        struct Describe<std::span<uint8_t>> { static constexpr Type type = Type::Bytes; };
+        template<std::integral I> requires (!std::same_as<I, bool> && sizeof(I) <= sizeof(uint64_t))
+        struct Describe<I>
+        {
+            static constexpr Type type = static_cast<Type>(
+                static_cast<uint8_t>(std::is_signed_v<I> ? Type::I8 : Type::U8) +
+                std::bit_width(sizeof(I)) - 1);
+        };
+
+        template<typename T>
+        concept Describable = requires { Describe<std::remove_cvref_t<T>>::type; };
+
+        template<Describable T>
+        constexpr Type typeOf = Describe<std::remove_cvref_t<T>>::type;
+
+        /// The value of type `T` held in `value`.
+        template<Describable T>
+        constexpr std::remove_cvref_t<T> get(const Value & value)
+        {
+            using U = std::remove_cvref_t<T>;
+            if constexpr (std::same_as<U, bool>) { return value.b; }
+            else if constexpr (std::same_as<U, Undefined>) { return {}; }
+            else if constexpr (std::same_as<U, float>) { return value.f; }
+            else if constexpr (std::same_as<U, double>) { return value.d; }
+            else if constexpr (std::same_as<U, std::string_view>) { return value.str; }
+            else if constexpr (std::same_as<U, std::span<uint8_t>>) { return value.bytes; }
+            else if constexpr (std::is_signed_v<U>) { return static_cast<U>(value.i); }
+            else { return static_cast<U>(value.u); }
+        }
+
+        /// Holds `from` as a `Value`, see `get`.
+        template<Describable T>
+        constexpr Value wrap(const T & from)
+        {
+            using U = std::remove_cvref_t<T>;
+            Value value;
+            if constexpr (std::same_as<U, bool>) { value.b = from; }
+            else if constexpr (std::same_as<U, Undefined>) { }
+            else if constexpr (std::same_as<U, float>) { value.f = from; }
+            else if constexpr (std::same_as<U, double>) { value.d = from; }
+            else if constexpr (std::same_as<U, std::string_view>) { value.str = from; }
+            else if constexpr (std::same_as<U, std::span<uint8_t>>) { value.bytes = from; }
+            else if constexpr (std::is_signed_v<U>) { value.i = from; }
+            else { value.u = from; }
+            return value;
+        }
+
+        /// Decodes a value of `type` into `into`.
+        bool decode(Type type, Value & into, std::span<uint8_t> & buf);
+        /// Decodes an array of at least `types.size()` elements into
+        /// `into`, ignoring any after them, like `Cbor<std::tuple>`.
+        bool decodeArray(std::span<const Type> types, Value * into, std::span<uint8_t> & buf);
+        bool encode(Type type, const Value & value, SinkRef & out);
+
+        /// \brief A function's types, for `call`.
+        struct Signature
+        {
+            /// Calls `fn` (cast back to its real type) with `args`.
+            using Invoke = Value (*)(void (*fn)(), const Value * args);
+
+            Type ret;
+            std::span<const Type> args;
+            Invoke invoke;
+        };
+
+        /// Decodes the array of arguments in `args` into `values` (room
+        /// for one per argument), calls `fn` with them and encodes the
+        /// return into `ret`, only once `fn` has returned.
+        bool call(
+            const Signature & signature,
+            void (*fn)(),
+            Value * values,
+            std::span<uint8_t> & args,
+            SinkRef & ret);
+    }
 };
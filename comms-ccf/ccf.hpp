@@ -6,7 +6,7 @@
 # CCF -- Bringing It Together
 
 This header brings the separate parts ([COBS](#cobs.hpp),
-[CBOR](#cbor.hpp), [FNV-1A](#fnv1a.hpp) and the [circular
+[CBOR](#cbor.hpp), [checksums](#checksum.hpp) and the [circular
 buffer](#circular_buffer.hpp)) together to be able to do [RPC](#rpc.hpp)
 calls.
 
@@ -26,8 +26,8 @@ C format strings.
 
 #include "circular_buffer.hpp"
 #include "cbor.hpp"
+#include "checksum.hpp"
 #include "cobs.hpp"
-#include "fnv1a.hpp"
 
 #if defined(DEBUG_CCF)
 #include DEBUG_CCF
@@ -39,7 +39,6 @@ C format strings.
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
-#include <string.h>
 
 #include <algorithm>
 #include <iterator>
@@ -50,7 +49,15 @@ struct CcfConfig
 {
     size_t rxBufSize;
     size_t txBufSize;
+    /// Largest packet (channel, data and checksum) before framing, up
+    /// to 0xFFFF bytes, so the RX queue's frame sizes fit in two bytes
     size_t maxPktSize;
+    /// Framing variant, both ends need to agree on it, see
+    /// [COBS](#cobs.hpp)
+    Cobs::Variant framing = Cobs::Variant::Cobs;
+    /// Frame checksum, both ends need to agree on it, see
+    /// [checksums](#checksum.hpp)
+    Checksum::Kind checksum = Checksum::Kind::Fnv1a;
 };
 
 enum class Channels : uint8_t
@@ -75,9 +82,26 @@ enum class LogLevel : uint8_t
 template<CcfConfig Config>
 class Ccf
 {
-    using RxFrame = CircularBuffer<uint8_t, Config.rxBufSize, Config.maxPktSize>::Frame;
+    static_assert(
+        Config.maxPktSize <= 0xFFFF,
+        "Packets are at most 0xFFFF bytes, so the RX frame size prefix is two bytes");
 public:
-    using TxFrame = CircularBuffer<uint8_t, Config.txBufSize, Config.maxPktSize>::Frame;
+    /// The TX queue holds encoded frames, including the delimiter
+    static constexpr size_t maxTxFrameSize =
+        Cobs::maxEncodedSize(Config.maxPktSize, Config.framing) + 1;
+
+private:
+    using Check = Checksum::Policy<Config.checksum>;
+    using RxBuf = CircularBuffer<uint8_t, Config.rxBufSize, Config.maxPktSize>;
+    using TxBuf = CircularBuffer<uint8_t, Config.txBufSize, maxTxFrameSize>;
+    using RxFrame = RxBuf::Frame;
+public:
+    using TxFrame = TxBuf::Frame;
+
+    /// Channel, sequence number and function before RPC arguments/returns
+    static constexpr size_t rpcHeaderSize = 3;
+    /// Channel, sequence number, function and checksum
+    static constexpr size_t minPktSize = rpcHeaderSize + Check::size;
 
     /// \brief Push RX'ed character to RX queue. Safe to call from
     /// interrupt context.
@@ -88,37 +112,38 @@ public:
     /// you could use separate SPSC queues feeding into this queue.
     ///
     /// Call this with any characters received on the transport. It
-    /// returns `true` if it is time to call `poll`.
+    /// returns `true` if it is time to call `poll`. The checksum is checked
+    /// as the bytes arrive, so corrupted or truncated frames are dropped
+    /// here, without taking space in the queue or waking up `poll`.
     bool receiveCharacter(uint8_t byte)
     {
-        // Do get before feed, and always do feed to e.g. reset on \0
-        const uint8_t value = decoder.get(byte);
-        const bool do_output = decoder.feed(byte);
         // Not storing null byte because packet length is indicated in
-        // a different way
-        if (byte == 0)
-        {
-            if (!rxBuf.dropping())
-            {
-                rxBuf.notify();
-            }
-            else
+        // a different way. Header bytes (and continuation bytes, in frames
+        // with >254 bytes without any null terminators) emit nothing.
+        const bool frameEnd = decoder.feed(
+            byte,
+            [this](uint8_t value)
             {
-                rxBuf.reset_dropped();
-            }
-            return true;
+                rxBuf.push_back(value);
+                rxChecker.feed(value);
+            });
+        if (!frameEnd)
+        {
+            return false;
         }
-        else if (do_output)
+        // Only wake `poll` for complete frames with a good checksum
+        const bool ok = !rxBuf.dropping() && !decoder.truncated() && rxChecker.check();
+        rxChecker.reset();
+        if (ok)
         {
-            rxBuf.push_back(value);
+            rxBuf.notify();
         }
         else
         {
-            // This is expected for the header byte and continuation bytes
-            // (frames >255 bytes without any null terminators)
-            debugf(DEBUG "dropping %02X as !=0 and !do_output" END LOGLEVEL_ARGS, byte);
+            debugf(DEBUG "Dropping bad frame (truncated=%d)" END LOGLEVEL_ARGS, decoder.truncated());
+            rxBuf.discard();
         }
-        return false;
+        return ok;
     }
 
     /// \brief Get TX queue size. Safe to call from interrupt context.
@@ -140,19 +165,26 @@ public:
     template<typename Rpc>
     bool poll(const Rpc & rpc)
     {
+        static_assert(
+            Rpc::maxReturnSize <= sizeof(pktBuf) - rpcHeaderSize - Check::size,
+            "An RPC function can return more than fits in maxPktSize");
         bool output = false;
         std::optional<RxFrame> frame;
         while (rxBuf.get_frame(frame))
         {
-            size_t len = 0;
-            // Copy to a local buffer to make sure it is contiguous
-            for (auto c : *frame)
+            // Decoded in place in the RX queue (the frame keeps it from
+            // being overwritten), unless it wraps around the end, then it
+            // is copied to a local buffer to make it contiguous
+            const auto [head, tail] = frame->segments();
+            std::span<uint8_t> span{head};
+            if (!tail.empty())
             {
-                pktBuf[len++] = c;
+                std::ranges::copy(tail, std::ranges::copy(head, pktBuf).out);
+                span = std::span{pktBuf, head.size() + tail.size()};
             }
-            std::span span{pktBuf, len};
+            const size_t len = span.size();
 
-            if (len < 6)
+            if (len < minPktSize)
             {
                 /// \todo Just using checksumless zero-length packets to
                 /// indicate error for now.
@@ -168,32 +200,24 @@ public:
             /// \todo Dispatch on channel
             (void)channel;
 
-            if (!Fnv1a::checkAtEnd(span))
-            {
-                /// \todo Just using checksumless zero-length packets
-                /// to indicate error for now.
-                debugf(WARN "Corrupted request (chan=%u)" END LOGLEVEL_ARGS, channel);
-                std::ranges::copy("Corrupted request\n", std::back_inserter(txBuf));
-                txBuf.push_back(static_cast<uint8_t>(0));
-                txBuf.notify();
-                output = true;
-                continue;
-            }
-            // Remove channel + checksum
+            // The checksum was checked in `receiveCharacter`, remove
+            // channel + checksum
             span = span.subspan(
                 sizeof(channel),
-                span.size() - Fnv1a::size - sizeof(channel));
+                span.size() - Check::size - sizeof(channel));
 
             uint8_t seqNo = span[0];
             uint8_t function = span[1];
             span = span.subspan(sizeof(seqNo) + sizeof(function));
-            // Reuse the pktBuf buffer for return (leaving space for
-            // channel, function, and checksum)
-            auto header = sizeof(channel) + sizeof(seqNo) + sizeof(function);
-            auto ret = std::span<uint8_t>(
-                pktBuf + header, sizeof(pktBuf) - header - Fnv1a::size);
+            // The return is encoded straight into the TX queue, after the
+            // header (channel, sequence number and function), but only
+            // once the function has returned, so it can log
+            static_assert(rpcHeaderSize == sizeof(channel) + sizeof(seqNo) + sizeof(function));
+            ResponseSink response{*this, static_cast<uint8_t>(seqNo + 1), function};
+            Cbor::SinkRef ret{response};
             if (!rpc.call(function, span, ret))
             {
+                response.discard();
                 /// \todo Just using checksumless zero-length packets
                 /// to indicate error for now.
                 debugf(WARN "RPC failed (function=%u)" END LOGLEVEL_ARGS, function);
@@ -203,12 +227,7 @@ public:
                 output = true;
                 continue;
             }
-            pktBuf[0] = channel;
-            pktBuf[1] = seqNo + 1;
-            pktBuf[2] = function;
-            auto respLen = static_cast<size_t>(ret.data() - pktBuf);
-            std::span resp{pktBuf + sizeof(channel), respLen - sizeof(channel)};
-            output = output || send(Channels::Rpc, resp);
+            output = response.finish() || output;
         }
         return output;
     }
@@ -227,38 +246,152 @@ public:
     /// get switched out between each-other
     bool send(Channels channel, std::span<uint8_t> & data)
     {
-        const size_t toSend = data.size() + sizeof(channel) + Fnv1a::size;
-        if (toSend > sizeof(pktBuf))
+        FrameSink frame{*this, channel};
+        frame.put(data);
+        return frame.finish();
+    }
+
+    /// \brief A `Cbor::Sink` for one frame on a channel, checksummed and
+    /// framed straight into the TX queue as it is written, so data can be
+    /// encoded without a buffer to copy from (like `send` needs).
+    /// \note **Not threadsafe**, use a mutex, and only one at a time
+    /// (they write the same end of the TX queue). One opened while
+    /// another is still open fails, rather than corrupting both.
+    ///
+    /// Room is reserved in the queue as the frame grows, for the worst
+    /// case framing of what has been written so far. Call `finish` to send
+    /// it, otherwise (e.g. if encoding fails part way) it is dropped.
+    class FrameSink
+    {
+    public:
+        FrameSink(Ccf & ccf_, Channels channel)
+            : ccf(ccf_), writer{TxOut{&ccf_.txBuf}}, nested(ccf_.frameOpen)
         {
-            debugf("Data for send too large\n");
-            return false;
+            if (nested)
+            {
+                debugf(WARN "Frame opened while another is open" END LOGLEVEL_ARGS);
+                failed = true;
+                return;
+            }
+            ccf.frameOpen = true;
+            const uint8_t chan = static_cast<uint8_t>(channel);
+            put(std::span{&chan, 1});
         }
-        std::span resp{pktBuf, toSend};
-        // Note: memmove caters for overlapping pktBuf/data (though no
-        // need to move if it is already in place)
-        if (&data[0] != &resp[1])
+        FrameSink(const FrameSink &) = delete;
+        FrameSink & operator=(const FrameSink &) = delete;
+        ~FrameSink()
         {
-            memmove(&resp[1], data.data(), data.size_bytes());
+            if (!finished)
+            {
+                discard();
+            }
         }
-        uint8_t chan = static_cast<uint8_t>(channel);
-        resp[0] = chan;
-        Fnv1a::putAtEnd(resp);
-        for (auto c : Cobs::Encoder(resp))
+
+        bool put(std::span<const uint8_t> bytes)
         {
-            txBuf.push_back(c);
+            const size_t toSend = written + bytes.size() + Check::size;
+            if (failed)
+            {
+                return false;
+            }
+            if (toSend > Config.maxPktSize)
+            {
+                debugf(WARN "Data for send too large" END LOGLEVEL_ARGS);
+                failed = true;
+                return false;
+            }
+            if (!ccf.txBuf.reserve(Cobs::maxEncodedSize(toSend, Config.framing) + 1))
+            {
+                debugf(WARN "No space in TX buffer for %zu bytes" END LOGLEVEL_ARGS, toSend);
+                failed = true;
+                return false;
+            }
+            push(bytes);
+            return true;
         }
-        txBuf.push_back(static_cast<uint8_t>(0));
-        if (txBuf.dropping())
+        /// Room for up to `stagingSize` bytes (e.g. a bounded item, see
+        /// `Cbor::encodeIfRoom`), which `commit` then checksums and frames
+        /// in one pass, without the checks of `put`.
+        uint8_t * reserve(size_t size)
         {
-            txBuf.reset_dropped();
-            return false;
+            const size_t toSend = written + size + Check::size;
+            if (failed || size > sizeof(staging) || toSend > Config.maxPktSize)
+            {
+                return nullptr;
+            }
+            if (!ccf.txBuf.reserve(Cobs::maxEncodedSize(toSend, Config.framing) + 1))
+            {
+                debugf(WARN "No space in TX buffer for %zu bytes" END LOGLEVEL_ARGS, toSend);
+                failed = true;
+                return nullptr;
+            }
+            return staging;
         }
-        else
+        void commit(size_t size) { push(std::span{staging, size}); }
+
+        /// Bytes written so far, including the channel.
+        size_t size() const { return written; }
+
+        /// Appends the checksum and queues the frame, or drops it if
+        /// anything didn't fit.
+        bool finish()
         {
-            txBuf.notify();
+            if (failed)
+            {
+                discard();
+                return false;
+            }
+            finished = true;
+            ccf.frameOpen = false;
+            writer.push(Checksum::bytes<Config.checksum>(state));
+            const size_t encoded = writer.finish();
+            ccf.txBuf.reserved(encoded) = 0;
+            ccf.txBuf.commit(encoded + 1);
+            ccf.txBuf.notify();
             return true;
         }
-    }
+
+        /// Drops the frame, e.g. to send something else instead.
+        void discard()
+        {
+            if (!finished && !nested)
+            {
+                ccf.frameOpen = false;
+                ccf.txBuf.discard();
+            }
+            finished = true;
+        }
+
+    private:
+        /// Checksums and frames `bytes` into the room already reserved.
+        void push(std::span<const uint8_t> bytes)
+        {
+            for (const auto byte : bytes)
+            {
+                state = Check::feed(state, byte);
+                writer.push(byte);
+            }
+            written += bytes.size();
+        }
+
+        struct TxOut
+        {
+            TxBuf * txBuf;
+            uint8_t & operator()(size_t index) const { return txBuf->reserved(index); }
+        };
+
+        Ccf & ccf;
+        Cobs::Writer<Config.framing, TxOut> writer;
+        typename Check::State state = Check::initial;
+        size_t written = 0;
+        /// Opened inside another, so never touches the TX queue
+        bool nested;
+        /// Enough for any scalar or header, and small tuples and arrays
+        static constexpr size_t stagingSize = 16;
+        uint8_t staging[stagingSize];
+        bool failed = false;
+        bool finished = false;
+    };
 
     /// \fn std::optional< size_t > logToBuffer (std::span< uint8_t > &span, LogLevel level, uint8_t module, const char *fmt,...)
     ///
@@ -313,6 +446,16 @@ public:
         va_list args)
 #endif
     {
+#if defined(DEFERRED_FORMATTING)
+        auto rest = span;
+        if (!encodeLog(rest, level, module, fmt, std::forward<Args>(args)...))
+        {
+            return {};
+        }
+        const size_t total = span.size() - rest.size();
+        span = rest;
+        return {total};
+#else
         if (module > (1 << 5) - 1)
         {
             return {};
@@ -321,12 +464,6 @@ public:
         span[0] = initialByte;
         // Space for length
         const auto start = span.begin() + 2;
-#if defined(DEFERRED_FORMATTING)
-        const auto written = std::distance(start, std::ranges::copy(fmt, start).out);
-        auto rest = span.subspan(2 + written);
-        bool ok = (Cbor::Cbor<Args>::encode(std::forward<Args>(args), rest) && ...);
-        const auto end = rest.begin();
-#else
         int written = vsnprintf(
             reinterpret_cast<char *>(&*start),
             std::distance(start, span.end()),
@@ -335,7 +472,6 @@ public:
         );
         bool ok = 0 < written && static_cast<size_t>(written) < span.size();
         const auto end = start + written;
-#endif
         span[1] = written;
         if (!ok)
         {
@@ -344,13 +480,14 @@ public:
         size_t total = std::distance(span.begin(), end);
         span = span.subspan(total);
         return {total};
+#endif
     }
 
     /// \fn std::optional<size_t> log(LogLevel level, uint8_t module, const char * fmt, ...)
     ///
     /// \brief Sends a logs message.
-    /// \note **Not threadsafe**, use a mutex -- in particular don't
-    /// call from inside RPC functions either!
+    /// \note **Not threadsafe**, use a mutex. RPC functions can log, as
+    /// `poll` only writes their return once they have returned.
     ///
     /// Log some data. Returns the number of bytes logged (all the bytes
     /// not just the formatted string), or nullopt if failed to log.
@@ -375,15 +512,20 @@ public:
         ...)
 #endif
     {
-        std::span<uint8_t> span{pktBuf};
 #if defined(DEFERRED_FORMATTING)
-        const auto formatted = logToBuffer(span, level, module, fmt, std::forward<Args>(args)...);
+        // Encoded straight into the TX queue, nothing to format first
+        FrameSink frame{*this, Channels::Log};
+        if (encodeLog(frame, level, module, fmt, std::forward<Args>(args)...) && frame.finish())
+        {
+            return {frame.size() - sizeof(Channels)};
+        }
+        return {};
 #else
+        std::span<uint8_t> span{pktBuf};
         va_list args;
         va_start(args, fmt);
         const auto formatted = vLogToBuffer(span, level, module, fmt, args);
         va_end(args);
-#endif
         if (formatted)
         {
             std::span<uint8_t> toSend{pktBuf, *formatted};
@@ -393,13 +535,85 @@ public:
             }
         }
         return {};
+#endif
     }
 
 
 private:
-    CircularBuffer<uint8_t, Config.txBufSize, Config.maxPktSize> txBuf;
-    CircularBuffer<uint8_t, Config.rxBufSize, Config.maxPktSize> rxBuf;
-    Cobs::Decoder decoder{};
+    /// \brief The `Cbor::Sink` for an RPC return, which only opens its
+    /// frame (with the header) when the return starts being encoded.
+    ///
+    /// `Rpc::call` encodes the return after the function has returned,
+    /// so the function can itself `log` or `send` without opening a
+    /// second frame inside this one.
+    class ResponseSink
+    {
+    public:
+        ResponseSink(Ccf & ccf_, uint8_t seqNo, uint8_t function)
+            : ccf(ccf_), header{seqNo, function} { }
+
+        bool put(std::span<const uint8_t> bytes) { return open().put(bytes); }
+        uint8_t * reserve(size_t size) { return open().reserve(size); }
+        void commit(size_t size) { open().commit(size); }
+
+        bool finish() { return open().finish(); }
+        void discard()
+        {
+            if (frame)
+            {
+                frame->discard();
+            }
+        }
+
+    private:
+        FrameSink & open()
+        {
+            if (!frame)
+            {
+                frame.emplace(ccf, Channels::Rpc);
+                frame->put(header);
+            }
+            return *frame;
+        }
+
+        Ccf & ccf;
+        const uint8_t header[2];
+        std::optional<FrameSink> frame;
+    };
+
+#if defined(DEFERRED_FORMATTING)
+    /// The log header (level, module and format string length), format
+    /// string and arguments.
+    template<Cbor::Sink Out, typename... Args>
+    static bool encodeLog(
+        Out & out,
+        LogLevel level,
+        uint8_t module,
+        std::string_view fmt,
+        Args && ... args)
+    {
+        if (module > (1 << 5) - 1)
+        {
+            return false;
+        }
+        const uint8_t header[] = {
+            static_cast<uint8_t>((static_cast<uint8_t>(level) << 5) | module),
+            static_cast<uint8_t>(fmt.size()),
+        };
+        return
+            Cbor::put(out, header) &&
+            Cbor::put(out, std::span{reinterpret_cast<const uint8_t *>(fmt.data()), fmt.size()}) &&
+            (Cbor::Cbor<Args>::encode(std::forward<Args>(args), out) && ...);
+    }
+#endif
+
+
+    TxBuf txBuf;
+    RxBuf rxBuf;
+    Cobs::Decoder<Config.framing> decoder{};
+    Checksum::Checker<Config.checksum> rxChecker{};
+    /// A `FrameSink` is writing to the TX queue
+    bool frameOpen = false;
     uint8_t pktBuf[Config.maxPktSize];
 };
 
@@ -0,0 +1,241 @@
+/**
+\file
+\brief Choice of frame checksum, see `CcfConfig::checksum`.
+
+# Checksum policies
+
+Every frame ends with a checksum of the channel and data, little endian.
+Which one is a trade off between speed, size on the wire and how many
+errors it catches, so it is chosen at compile time with `Checksum::Kind`
+(both ends need to agree):
+
+- `Fnv1a`: the default [FNV-1A](#fnv1a.hpp) hash, 4 bytes. Simple and
+  small, but a byte at a time.
+- `Crc32c`: [CRC-32C](#crc.hpp), 4 bytes, using slicing-by-8 for spans.
+  Faster on hosts, but the tables take 8 KiB.
+- `Crc32cHw`: the same CRC-32C on the wire, using the SSE4.2 or ARMv8
+  CRC32C instructions. Only compiles for targets that have them.
+- `Crc16`: [CRC-16/CCITT-FALSE](#crc.hpp), 2 bytes, for slow links.
+- `None`: no checksum, for transports that are already reliable (e.g.
+  TCP or stdio).
+
+Each `Policy` has the same shape:
+
+    struct Policy<Kind::...>
+    {
+        using State = ...;
+        static constexpr size_t size;       // Bytes on the wire
+        static constexpr State initial;
+        static constexpr State feed(State state, uint8_t byte);
+        static constexpr State update(State state, std::span<const uint8_t> span);
+        static constexpr uint32_t value(State state);  // As sent
+    };
+
+*/
+
+#pragma once
+
+#include "crc.hpp"
+#include "fnv1a.hpp"
+
+#if defined(DEBUG_CHECKSUM)
+#include DEBUG_CHECKSUM
+#else
+#include "ndebug.hpp"
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <array>
+#include <span>
+
+namespace Checksum
+{
+    enum class Kind : uint8_t
+    {
+        Fnv1a,
+        Crc32c,
+        Crc32cHw,
+        Crc16,
+        None,
+    };
+
+    /// Only used for `Crc32cHw` on targets without the instructions.
+    template<Kind K>
+    struct Policy
+    {
+        static_assert(
+            K != Kind::Crc32cHw,
+            "Crc32cHw needs SSE4.2 (-msse4.2) or the ARMv8 CRC extension"
+            " (-march=armv8-a+crc), use Crc32c otherwise");
+    };
+
+    template<>
+    struct Policy<Kind::Fnv1a>
+    {
+        using State = uint32_t;
+        static constexpr size_t size = Fnv1a::size;
+        static constexpr State initial = Fnv1a::initialHash;
+        static constexpr State feed(State state, uint8_t byte)
+        {
+            return Fnv1a::feed(state, byte);
+        }
+        static constexpr State update(State state, std::span<const uint8_t> span)
+        {
+            for (auto c : span)
+            {
+                state = Fnv1a::feed(state, c);
+            }
+            return state;
+        }
+        static constexpr uint32_t value(State state) { return state; }
+    };
+
+    template<>
+    struct Policy<Kind::Crc32c>
+    {
+        using State = uint32_t;
+        static constexpr size_t size = Crc32c::size;
+        static constexpr State initial = Crc32c::initialCrc;
+        static constexpr State feed(State state, uint8_t byte)
+        {
+            return Crc32c::feed(state, byte);
+        }
+        static constexpr State update(State state, std::span<const uint8_t> span)
+        {
+            return Crc32c::checksum(span, state);
+        }
+        static constexpr uint32_t value(State state) { return Crc32c::final(state); }
+    };
+
+#if defined(__SSE4_2__) || defined(__ARM_FEATURE_CRC32)
+    template<>
+    struct Policy<Kind::Crc32cHw> : Policy<Kind::Crc32c>
+    {
+        static State feed(State state, uint8_t byte)
+        {
+            return Crc32c::feedHw(state, byte);
+        }
+        static State update(State state, std::span<const uint8_t> span)
+        {
+            return Crc32c::checksumHw(span, state);
+        }
+    };
+#endif
+
+    template<>
+    struct Policy<Kind::Crc16>
+    {
+        using State = uint16_t;
+        static constexpr size_t size = Crc16::size;
+        static constexpr State initial = Crc16::initialCrc;
+        static constexpr State feed(State state, uint8_t byte)
+        {
+            return Crc16::feed(state, byte);
+        }
+        static constexpr State update(State state, std::span<const uint8_t> span)
+        {
+            return Crc16::checksum(span, state);
+        }
+        static constexpr uint32_t value(State state) { return state; }
+    };
+
+    template<>
+    struct Policy<Kind::None>
+    {
+        using State = uint8_t;
+        static constexpr size_t size = 0;
+        static constexpr State initial = 0;
+        static constexpr State feed(State state, uint8_t) { return state; }
+        static constexpr State update(State state, std::span<const uint8_t>) { return state; }
+        static constexpr uint32_t value(State) { return 0; }
+    };
+
+    /// The checksum as it goes on the wire (little endian).
+    template<Kind K>
+    constexpr std::array<uint8_t, Policy<K>::size> bytes(typename Policy<K>::State state)
+    {
+        const uint32_t value = Policy<K>::value(state);
+        std::array<uint8_t, Policy<K>::size> out{};
+        for (size_t i = 0; i < out.size(); ++i)
+        {
+            out[i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+        return out;
+    }
+
+    /// Checks that the checksum of span[:-size] is at span[-size:].
+    template<Kind K>
+    constexpr bool checkAtEnd(std::span<const uint8_t> span)
+    {
+        using P = Policy<K>;
+        if (span.size() < P::size)
+        {
+            return false;
+        }
+        const auto got = bytes<K>(P::update(P::initial, span.first(span.size() - P::size)));
+        return std::ranges::equal(got, span.last(P::size));
+    }
+
+    /// \brief Checks the checksum at the end of bytes as they arrive, e.g.
+    /// in a receive interrupt, so the frame doesn't need another pass.
+    ///
+    /// Until the end we don't know which bytes are the checksum, so each
+    /// byte is only fed to it once `size` more have arrived after it.
+    template<Kind K>
+    class Checker
+    {
+        using P = Policy<K>;
+        static_assert(P::size <= sizeof(uint32_t));
+
+    public:
+        constexpr void feed(uint8_t byte)
+        {
+            if constexpr (P::size > 0)
+            {
+                if (count == P::size)
+                {
+                    state = P::feed(state, static_cast<uint8_t>(last));
+                }
+                else
+                {
+                    ++count;
+                }
+                // Little endian, as on the wire
+                last = (last >> 8) | (static_cast<uint32_t>(byte) << (8 * (P::size - 1)));
+            }
+        }
+
+        /// Whether the last `size` bytes fed are the checksum of the ones
+        /// before.
+        bool check() const
+        {
+            if (count == P::size && P::value(state) == last)
+            {
+                debugf(INFO "Checksum OK" END LOGLEVEL_ARGS);
+                return true;
+            }
+            debugf(INFO "Checksum got %08X expected %08X" END LOGLEVEL_ARGS,
+                static_cast<unsigned>(P::value(state)), static_cast<unsigned>(last));
+            return false;
+        }
+
+        constexpr void reset()
+        {
+            state = P::initial;
+            last = 0;
+            count = 0;
+        }
+
+    private:
+        typename P::State state = P::initial;
+        /// The last `size` bytes, which might be the checksum
+        uint32_t last = 0;
+        uint8_t count = 0;
+    };
+};
+
+// This is a header, undefine the debugf macro
+#include "debug_end.hpp"
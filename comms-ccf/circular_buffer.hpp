@@ -41,7 +41,8 @@ fit into the buffer.
 
 This does mean that we need to know how big a packet can be (specifically,
 how many bytes to allocate for the packet size pointer), but this is
-fine for now.
+fine for now. The size is stored most significant byte first, using the
+smallest type which can hold `MaxPacketSize`.
 
 \todo Currently this was written for architectures which don't reorder
 reads/writes, in my case small microcontrollers without caches and write
@@ -71,9 +72,11 @@ to the DMA engine.
 #include <stddef.h>
 #include <stdint.h>
 
+#include <algorithm>
 #include <array>
 #include <bit>
 #include <optional>
+#include <span>
 #include <type_traits>
 #include <utility>
 
@@ -88,7 +91,9 @@ public:
 
     using value_type = Value;
 
-    static constexpr size_t sizeBytes = sizeof(SmallestTypeT<MaxPacketSize>);
+    /// Type of the packet size stored before each packet.
+    using FrameSize = SmallestTypeT<MaxPacketSize>;
+    static constexpr size_t sizeBytes = sizeof(FrameSize);
 
     constexpr size_t capacity() const { return Size; }
     size_t size() const { return write - read; }
@@ -124,6 +129,38 @@ public:
         }
     }
 
+    /// \brief Checks up front that `maxSize` more elements fit in the
+    /// current packet, to then write them with `reserved` and `commit`
+    /// without the per-element checks of `push_back`.
+    ///
+    /// Returns false (and starts dropping, like `push_back`) if they
+    /// won't fit.
+    bool reserve(size_t maxSize)
+    {
+        if ((!dropped) && (notified == write))
+        {
+            write += sizeBytes;
+        }
+        if (unnotified() + maxSize > MaxPacketSize || size() + maxSize > capacity())
+        {
+            dropped = true;
+        }
+        return !dropped;
+    }
+
+    /// Element `index` past the end of the queue, only valid for indices
+    /// less than the size given to a successful `reserve`.
+    Value & reserved(size_t index)
+    {
+        return buf[(write + index) % Size];
+    }
+
+    /// Adds the first `n` elements written with `reserved` to the queue.
+    void commit(size_t n)
+    {
+        write += n;
+    }
+
     /// Drop the first element from the queue.
     void pop_front()
     {
@@ -159,6 +196,14 @@ public:
         }
     }
 
+    /// Discards the elements pushed since the most recent frame, e.g.
+    /// when the producer finds the packet is bad.
+    void discard()
+    {
+        dropped = false;
+        write = notified;
+    }
+
     /// Delimit the elements pushed since the most recent frame as one
     /// packet. The consumer can then use get_frame to get a range onto
     /// the queue.
@@ -172,9 +217,10 @@ public:
         // packet.
         reset_dropped();
         size_t size = unnotified();
+        // Most significant byte first, as `get_frame` reads it
         for (size_t i = sizeBytes; i > 0; --i)
         {
-            buf[notified++ % Size] = static_cast<uint8_t>(size);
+            buf[(notified + i - 1) % Size] = static_cast<uint8_t>(size);
             size >>= 8;
         }
         notified = write;
@@ -207,7 +253,7 @@ public:
     class Frame
     {
     public:
-        Frame(CircularBuffer * parent_, size_t start, uint8_t len)
+        Frame(CircularBuffer * parent_, size_t start, FrameSize len)
           : parent(parent_),
             begin_(parent, start),
             end_(parent, start + len) {}
@@ -237,6 +283,24 @@ public:
         Iterator & begin() { return begin_; }
         Iterator & end() { return end_; }
 
+        /// \brief The frame in place in the queue, as the part up to the
+        /// end of the storage and the part wrapped around to the start
+        /// (empty unless the frame wraps).
+        ///
+        /// Only valid while the frame is, which keeps the queue from
+        /// reusing it. E.g. to decode a frame without copying it first,
+        /// unless it wraps.
+        std::array<std::span<Value>, 2> segments() const
+        {
+            const size_t start = begin_.index % Size;
+            const size_t len = end_.index - begin_.index;
+            const size_t first = std::min(len, Size - start);
+            return {
+                std::span<Value>{parent->buf.data() + start, first},
+                std::span<Value>{parent->buf.data(), len - first},
+            };
+        }
+
         CircularBuffer * parent = nullptr;
         Iterator begin_;
         Iterator end_;
@@ -277,7 +341,7 @@ public:
         }
         if (start != end)
         {
-            frame.emplace(this, start, size);
+            frame.emplace(this, start, static_cast<FrameSize>(size));
         }
         else
         {
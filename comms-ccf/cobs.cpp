@@ -7,48 +7,334 @@
 #endif
 
 #include <stdint.h>
+#include <string.h>
 
+#include <algorithm>
+#include <bit>
+#include <optional>
 #include <span>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace Cobs
 {
-    uint8_t Encoder::findRunLength()
+    namespace
+    {
+        /// Returns the index of the first zero in `data[0:size]`, or
+        /// `size` if there isn't one.
+        ///
+        /// Uses vector compares where available, then a 32-bit SWAR
+        /// (SIMD within a register) zero-byte test for the rest, which is
+        /// also what Cortex-M gets as it can do unaligned word loads.
+        size_t findZero(const uint8_t * data, size_t size)
+        {
+            size_t idx = 0;
+#if defined(__AVX2__)
+            for (; idx + 32 <= size; idx += 32)
+            {
+                const __m256i chunk = _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i *>(data + idx));
+                const uint32_t zeros = static_cast<uint32_t>(_mm256_movemask_epi8(
+                    _mm256_cmpeq_epi8(chunk, _mm256_setzero_si256())));
+                if (zeros != 0)
+                {
+                    return idx + std::countr_zero(zeros);
+                }
+            }
+#endif
+#if defined(__SSE2__)
+            for (; idx + 16 <= size; idx += 16)
+            {
+                const __m128i chunk = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i *>(data + idx));
+                const uint32_t zeros = static_cast<uint32_t>(_mm_movemask_epi8(
+                    _mm_cmpeq_epi8(chunk, _mm_setzero_si128())));
+                if (zeros != 0)
+                {
+                    return idx + std::countr_zero(zeros);
+                }
+            }
+#elif defined(__ARM_NEON)
+            for (; idx + 16 <= size; idx += 16)
+            {
+                const uint8x16_t eq = vceqq_u8(vld1q_u8(data + idx), vdupq_n_u8(0));
+                // Narrowing shift turns each byte of the compare into a
+                // nibble, as NEON has no movemask
+                const uint64_t zeros = vget_lane_u64(vreinterpret_u64_u8(
+                    vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+                if (zeros != 0)
+                {
+                    return idx + std::countr_zero(zeros) / 4;
+                }
+            }
+#endif
+            for (; idx + sizeof(uint32_t) <= size; idx += sizeof(uint32_t))
+            {
+                uint32_t word;
+                memcpy(&word, data + idx, sizeof(word));
+                // High bit set exactly in the zero bytes (no false
+                // positives from borrows, unlike `(w - 0x01..) & ~w`)
+                const uint32_t zeros =
+                    ~(((word & 0x7F7F7F7F) + 0x7F7F7F7F) | word | 0x7F7F7F7F);
+                if (zeros != 0)
+                {
+                    const int bit = std::endian::native == std::endian::little
+                        ? std::countr_zero(zeros)
+                        : std::countl_zero(zeros);
+                    return idx + bit / 8;
+                }
+            }
+            for (; idx < size; ++idx)
+            {
+                if (data[idx] == 0)
+                {
+                    break;
+                }
+            }
+            return idx;
+        }
+    }
+
+    void Segments::advance(size_t n)
+    {
+        // May cross segments, e.g. the two zeros of a COBS/ZPE pair
+        while (n >= data.size() && !rest.empty())
+        {
+            n -= data.size();
+            data = rest[0];
+            rest = rest.subspan(1);
+        }
+        data = data.subspan(std::min(n, data.size()));
+        while (data.empty() && !rest.empty())
+        {
+            data = rest[0];
+            rest = rest.subspan(1);
+        }
+    }
+
+    std::optional<uint8_t> Segments::peek(size_t n) const
+    {
+        if (n < data.size())
+        {
+            return data[n];
+        }
+        n -= data.size();
+        for (const auto segment : rest)
+        {
+            if (n < segment.size())
+            {
+                return segment[n];
+            }
+            n -= segment.size();
+        }
+        return {};
+    }
+
+    template<Variant V>
+    std::optional<size_t> encode(std::span<const uint8_t> in, std::span<uint8_t> out)
+    {
+        return encode<V>(std::span{&in, 1}, out);
+    }
+
+    template<Variant V>
+    std::optional<size_t> encode(
+        std::span<const std::span<const uint8_t>> in,
+        std::span<uint8_t> out)
+    {
+        constexpr size_t maxRun = maxRunLengthOf<V>;
+        // The header is written once we know where the run ends
+        size_t header = 0;
+        size_t written = 0;
+        size_t run = 0;
+        bool open = false;
+        const auto openRun = [&]()
+        {
+            if (written == out.size())
+            {
+                debugf(WARN "encode: no space for header" END LOGLEVEL_ARGS);
+                return false;
+            }
+            header = written++;
+            run = 0;
+            open = true;
+            return true;
+        };
+
+        if (!openRun())
+        {
+            return {};
+        }
+        Segments input{{}, in};
+        input.advance(0);
+        while (!input.empty())
+        {
+            // After a maximum length run, only start the next one if
+            // there is more data
+            if (!open && !openRun())
+            {
+                return {};
+            }
+            const size_t limit = std::min<size_t>(input.data.size(), maxRun - run);
+            const size_t len = findZero(input.data.data(), limit);
+            if (out.size() - written < len)
+            {
+                debugf(WARN "encode: no space for run of %zu" END LOGLEVEL_ARGS, len);
+                return {};
+            }
+            std::copy_n(input.data.data(), len, out.data() + written);
+            written += len;
+            run += len;
+            input.advance(len);
+            if (run == maxRun)
+            {
+                // No implicit zero, the next header continues the run
+                out[header] = static_cast<uint8_t>(run + 1);
+                open = false;
+            }
+            else if (len < limit)
+            {
+                // Pointer to the first zero byte, not the last
+                // non-zero byte. Then skip over the zero, which always
+                // starts another run (even at the very end).
+                input.advance(1);
+                if (V == Variant::Zpe
+                    && run <= zpeMaxPairRunLength
+                    && (input.empty() || input.data[0] == 0))
+                {
+                    out[header] = static_cast<uint8_t>(zpePairHeader + run);
+                    if (input.empty())
+                    {
+                        // The second zero is the implicit one at the end
+                        open = false;
+                        continue;
+                    }
+                    input.advance(1);
+                }
+                else
+                {
+                    out[header] = static_cast<uint8_t>(run + 1);
+                }
+                if (!openRun())
+                {
+                    return {};
+                }
+            }
+        }
+        if (open)
+        {
+            out[header] = static_cast<uint8_t>(run + 1);
+            if (V == Variant::CobsR && run > 0 && out[written - 1] >= out[header])
+            {
+                // The last byte stands in for the header, the decoder
+                // sees the run end early
+                out[header] = out[--written];
+            }
+        }
+        return written;
+    }
+
+    template<Variant V>
+    uint8_t Encoder<V>::findRunLength() const
     {
         // Because we output `runLength + 1`, i.e. the pointer to the
         // null not the last non-null byte, the maximum is 254
-        uint8_t idx = 0;
-        for (; idx < maxRunLength && idx < data.size(); ++idx)
+        size_t run = 0;
+        auto segment = input.data;
+        auto rest = input.rest;
+        while (true)
         {
-            if (data[idx] == 0)
+            const size_t limit = std::min<size_t>(segment.size(), maxRunLengthOf<V> - run);
+            const size_t len = findZero(segment.data(), limit);
+            run += len;
+            if (len < segment.size() || rest.empty())
             {
+                // Found a zero, reached the maximum, or ran out of data
                 break;
             }
+            segment = rest[0];
+            rest = rest.subspan(1);
         }
-        return idx;
+        return static_cast<uint8_t>(run);
     }
 
-    Encoder::value_type Encoder::operator*() const
+    template<Variant V>
+    void Encoder<V>::planRun()
+    {
+        runIndex = 0;
+        runLength = findRunLength();
+        header = runLength + 1;
+        const auto next = input.peek(runLength);
+        if (runLength == maxRunLengthOf<V>)
+        {
+            // No implicit zero, the next header continues the run
+            skip = 0;
+            last = !next;
+        }
+        else if (next)
+        {
+            // Next is a zero, for COBS/ZPE check for a pair, where the
+            // second zero can be the implicit one at the end
+            const auto after = input.peek(runLength + 1);
+            if (V == Variant::Zpe
+                && runLength <= zpeMaxPairRunLength
+                && (!after || *after == 0))
+            {
+                header = zpePairHeader + runLength;
+                skip = after ? 2 : 1;
+                last = !after;
+            }
+            else
+            {
+                skip = 1;
+                last = false;
+            }
+        }
+        else
+        {
+            skip = 0;
+            last = true;
+            if (V == Variant::CobsR && runLength > 0)
+            {
+                const uint8_t lastByte = *input.peek(runLength - 1);
+                if (lastByte >= header)
+                {
+                    // The last byte stands in for the header
+                    header = lastByte;
+                    --runLength;
+                    skip = 1;
+                }
+            }
+        }
+    }
+
+    template<Variant V>
+    Encoder<V>::value_type Encoder<V>::operator*() const
     {
         if (!runHeaderOutput)
         {
-            // Pointer to the first zero byte, not the last non-zero byte
-            return runLength + 1;
+            return header;
         }
         else
         {
-            return data[runIndex];
+            return input.data[0];
         }
     }
 
-    Encoder & Encoder::operator++()
+    template<Variant V>
+    Encoder<V> & Encoder<V>::operator++()
     {
         debugf(
-            DEBUG "op++ hdr? %s %d/%d/%ld char %02X ->" LOGLEVEL_ARGS,
+            DEBUG "op++ hdr? %s %d/%d/%zu ->" LOGLEVEL_ARGS,
             runHeaderOutput ? "done" : "todo",
             runIndex,
             runLength,
-            data.size(),
-            data[runIndex]
+            input.data.size()
         );
         if (!runHeaderOutput)
         {
@@ -57,70 +343,117 @@ namespace Cobs
         else if (runIndex < runLength)
         {
             ++runIndex;
+            input.advance(1);
         }
         // Not `else if`, need to recalculate before dereference
-        if (runIndex == runLength)
+        if (runIndex == runLength && !last)
         {
-            if (runIndex < data.size())
-            {
-                if (runLength < maxRunLength)
-                {
-                    // Skip over zero byte
-                    ++runIndex;
-                }
-                runHeaderOutput = false;
-            }
-            data = data.subspan(runIndex);
-            runIndex = 0;
-            runLength = findRunLength();
+            // Skip over the zero(s)
+            input.advance(skip);
+            runHeaderOutput = false;
+            planRun();
         }
         debugf(
-            " hdr? %s %d/%d/%ld char %02X" END,
+            " hdr? %s %d/%d/%zu" END,
             runHeaderOutput ? "done" : "todo",
             runIndex,
             runLength,
-            data.size(),
-            data[runIndex]
+            input.data.size()
         );
         return *this;
     }
 
-    bool Encoder::operator!=(std::nullptr_t) const
+    template<Variant V>
+    bool Encoder<V>::operator!=(std::nullptr_t) const
     {
-        bool atEnd = (runIndex == data.size()) && runHeaderOutput;
+        bool atEnd = runHeaderOutput && runIndex == runLength && last;
         return !atEnd;
     }
 
-    bool Decoder::feed(uint8_t byte)
+    template<Variant V>
+    Decoder<V>::Result Decoder<V>::decode(std::span<const uint8_t> in, std::span<uint8_t> out)
     {
-        bool skip = runLengthWasMax && runLength == 0;
-        if (byte == 0)
-        {
-            /// We reached an unescaped zero byte, our caller should
-            /// already know we are at the end -- reset for decoding
-            /// next frame
-            runLength = 0;
-            runLengthWasMax = true;
-            /// And don't say skip, to emit the null and not process the
-            /// next byte
-            return true;
-        }
-        else if (runLength == 0)
+        size_t consumed = 0;
+        size_t written = 0;
+        while (consumed < in.size())
         {
-            debugf(DEBUG "runLength == 0 at byte %02X" END LOGLEVEL_ARGS, byte);
-            runLength = byte;
-            runLengthWasMax = runLength - 1 == maxRunLength;
+            const uint8_t byte = in[consumed];
+            if (byte == 0)
+            {
+                frameTruncated = false;
+                if (runLength == 0)
+                {
+                    // The last implicit zero of a frame is not data
+                    const size_t pending = zeros > 1 ? zeros - 1 : 0;
+                    if (out.size() - written < pending)
+                    {
+                        break;
+                    }
+                    written = std::fill_n(out.begin() + written, pending, 0) - out.begin();
+                }
+                else if constexpr (V == Variant::CobsR)
+                {
+                    // The run was ended early by its header value
+                    if (written == out.size())
+                    {
+                        break;
+                    }
+                    out[written++] = header;
+                }
+                else
+                {
+                    debugf(DEBUG "decode: delimiter %u bytes early" END LOGLEVEL_ARGS, runLength);
+                    // Truncated frame, resynchronise on the delimiter
+                    frameTruncated = true;
+                }
+                reset();
+                return {consumed + 1, written, true, frameTruncated};
+            }
+            else if (runLength == 0)
+            {
+                // Zeros from the previous run, only output now as the
+                // last one in a frame is dropped
+                if (out.size() - written < zeros)
+                {
+                    break;
+                }
+                written = std::fill_n(out.begin() + written, zeros, 0) - out.begin();
+                zeros = 0;
+                start(byte);
+                ++consumed;
+            }
+            else
+            {
+                const size_t limit = std::min<size_t>(
+                    {runLength, in.size() - consumed, out.size() - written});
+                if (limit == 0)
+                {
+                    break;
+                }
+                // Stops early at a delimiter, handled above
+                const size_t run = findZero(in.data() + consumed, limit);
+                std::copy_n(in.data() + consumed, run, out.data() + written);
+                consumed += run;
+                written += run;
+                runLength -= run;
+            }
         }
-        --runLength;
-        return !skip;
+        return {consumed, written, false};
     }
 
-    uint8_t Decoder::get(uint8_t byte) const
-    {
-        if (runLength == 0)
-        {
-            return 0;
-        }
-        return byte;
-    }
+    template std::optional<size_t> encode<Variant::Cobs>(std::span<const uint8_t>, std::span<uint8_t>);
+    template std::optional<size_t> encode<Variant::CobsR>(std::span<const uint8_t>, std::span<uint8_t>);
+    template std::optional<size_t> encode<Variant::Zpe>(std::span<const uint8_t>, std::span<uint8_t>);
+    template std::optional<size_t> encode<Variant::Cobs>(
+        std::span<const std::span<const uint8_t>>, std::span<uint8_t>);
+    template std::optional<size_t> encode<Variant::CobsR>(
+        std::span<const std::span<const uint8_t>>, std::span<uint8_t>);
+    template std::optional<size_t> encode<Variant::Zpe>(
+        std::span<const std::span<const uint8_t>>, std::span<uint8_t>);
+    template class Encoder<Variant::Cobs>;
+    template class Encoder<Variant::CobsR>;
+    template class Encoder<Variant::Zpe>;
+    template class Decoder<Variant::Cobs>;
+    template class Decoder<Variant::CobsR>;
+    template class Decoder<Variant::Zpe>;
 };
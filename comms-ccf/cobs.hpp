@@ -29,6 +29,22 @@ This way the overhead is at most one extra byte every 255 bytes. And if there
 are zeros more frequently than that, then the overhead can be just one extra
 byte!
 
+# Variants
+
+The framing is selected at compile-time (see `Variant`, and the `framing`
+member of `CcfConfig`), both ends need to agree on it:
+
+- **COBS**: as above.
+- **COBS/R** (reduced): if the last byte of the frame is at least as large as
+  the last header would be, it replaces that header, so the frame is one byte
+  shorter. The decoder notices the delimiter arriving before the run is over,
+  and outputs the header value as the last byte. Small frames without zeros
+  are the usual case, so this often removes the overhead altogether.
+- **COBS/ZPE** (zero pair elimination): headers from 0xE1 mean a run of up to
+  30 bytes followed by *two* zeros, which suits zero-padded data such as
+  small integers. The cost is that the longest run without a zero is 223
+  bytes (header 0xE0) instead of 254.
+
 */
 
 #pragma once
@@ -36,33 +52,109 @@ byte!
 #include <stddef.h>
 #include <stdint.h>
 
-#include <span>
 #include <iterator>
+#include <optional>
+#include <ranges>
+#include <span>
 
 namespace Cobs
 {
+    /// Framing variants, see the file documentation.
+    enum class Variant : uint8_t
+    {
+        Cobs,
+        CobsR,
+        Zpe,
+    };
+
     /// Because we output `runLength + 1`, i.e. the pointer to the null
     /// not the last non-null byte, the maximum is 254
     constexpr uint8_t maxRunLength = 254;
 
+    /// COBS/ZPE headers from this one mean the run is followed by two
+    /// zeros, so the longest run without a zero has the header 0xE0.
+    constexpr uint8_t zpePairHeader = 0xE1;
+    constexpr uint8_t zpeMaxRunLength = zpePairHeader - 2;
+    constexpr uint8_t zpeMaxPairRunLength = 0xFF - zpePairHeader;
+
+    /// Maximum run length (without a zero) for the variant.
+    template<Variant V>
+    constexpr uint8_t maxRunLengthOf = V == Variant::Zpe ? zpeMaxRunLength : maxRunLength;
+
     /// Returns the maximum size required for encoding data of the
     /// given size.
-    constexpr size_t maxEncodedSize(size_t dataSize)
+    constexpr size_t maxEncodedSize(size_t dataSize, Variant variant = Variant::Cobs)
     {
-        size_t overhead = (dataSize + maxRunLength)/maxRunLength;
+        const size_t maxRun = variant == Variant::Zpe ? zpeMaxRunLength : maxRunLength;
+        size_t overhead = (dataSize + maxRun)/maxRun;
         return dataSize + overhead;
     }
 
+    /// \brief Encodes all of `in` into `out` in one go, returning the
+    /// number of bytes written, or nullopt if `out` is too small.
+    ///
+    /// Unlike the Encoder iterator, this writes into a contiguous buffer,
+    /// so it can find the zeros a word (or vector) at a time and copy
+    /// whole runs. Size `out` using `maxEncodedSize(in.size(), V)`.
+    ///
+    /// \note Like the Encoder, this doesn't add the zero delimiter.
+    template<Variant V = Variant::Cobs>
+    std::optional<size_t> encode(std::span<const uint8_t> in, std::span<uint8_t> out);
+
+    /// \brief Scatter-gather version of `encode`: encodes the
+    /// concatenation of the `in` spans (e.g. header, payload, trailer),
+    /// without them having to be copied together first.
+    ///
+    /// Runs carry over from one span to the next, so the output is the
+    /// same as encoding the concatenation.
+    template<Variant V = Variant::Cobs>
+    std::optional<size_t> encode(
+        std::span<const std::span<const uint8_t>> in,
+        std::span<uint8_t> out);
+
+    /// Position in the concatenation of some spans, for the encoders.
+    struct Segments
+    {
+        /// Rest of the current segment, starting at the next byte.
+        std::span<const uint8_t> data;
+        /// Segments after the current one.
+        std::span<const std::span<const uint8_t>> rest;
+
+        bool empty() const { return data.empty(); }
+
+        /// Moves `n` bytes along `data`, then on to the next non-empty
+        /// segment if `data` has been used up.
+        void advance(size_t n);
+
+        /// Byte `n` bytes ahead, if there is one.
+        std::optional<uint8_t> peek(size_t n) const;
+    };
+
     /// Encodes data from a buffer (given at constructino time) to the
     /// output of the iterator.
     ///
     /// \note Encoder is itself the iterator.
+    template<Variant V = Variant::Cobs>
     class Encoder
     {
     public:
         template<size_t Extent>
         Encoder(std::span<const uint8_t, Extent> _data)
-        : data(_data), runLength(findRunLength()) { }
+        : input{_data, {}}
+        {
+            planRun();
+        }
+
+        /// Encodes the concatenation of the segments, like the
+        /// scatter-gather `encode`. The segments must outlive the
+        /// encoder (the span of segments too, not just their data).
+        template<size_t Extent>
+        Encoder(std::span<const std::span<const uint8_t>, Extent> _segments)
+        : input{{}, _segments}
+        {
+            input.advance(0);
+            planRun();
+        }
 
         template<size_t Extent>
         Encoder(std::span<uint8_t, Extent> span)
@@ -92,32 +184,241 @@ namespace Cobs
         /// And that might end up looping over the data twice too, the second
         /// time in the copying from the buffer.
         ///
-        /// Ultimately, not a problem until it is clear it becomes one.
-        uint8_t findRunLength();
+        /// Ultimately, not a problem until it is clear it becomes one. And
+        /// when the output is a contiguous buffer, use `Cobs::encode`.
+        uint8_t findRunLength() const;
 
-        std::span<const uint8_t> data;
+        /// Finds the next run and decides its header, and what follows it.
+        void planRun();
+
+        Segments input;
         /// A run is a sequence of contiguous non-zeroes (excluding the zero).
         uint8_t runLength;
         uint8_t runIndex = 0;
+        uint8_t header;
+        /// Number of input bytes after the run which the header stands
+        /// for (the zero, or pair of zeros; for COBS/R the last byte)
+        uint8_t skip;
+        /// Whether this run is the end of the input, i.e. no header follows
+        bool last;
         bool runHeaderOutput = false;
     };
-    static_assert(std::input_iterator<Encoder>);
+    static_assert(std::input_iterator<Encoder<>>);
+
+    /// \brief Encodes bytes pushed one at a time, into an output indexed
+    /// by position, e.g. space reserved in a circular buffer. Each header
+    /// is filled in once its run ends, so this is a single pass which can
+    /// be fused with other per-byte work such as checksumming.
+    ///
+    /// `out(index)` returns a `uint8_t &`, and needs to be valid for
+    /// `maxEncodedSize` of everything pushed, it is not bounds checked.
+    /// The output is the same as for `encode`.
+    template<Variant V, typename Out>
+    class Writer
+    {
+    public:
+        Writer(Out _out) : out(_out) { }
+
+        void push(uint8_t byte)
+        {
+            if (!open)
+            {
+                // Only start the next run after a maximum length run if
+                // there is more data
+                header = written++;
+                run = 0;
+                open = true;
+            }
+            if (V == Variant::Zpe && zeroPending)
+            {
+                zeroPending = false;
+                if (byte == 0)
+                {
+                    closeRun(static_cast<uint8_t>(zpePairHeader + run));
+                    return;
+                }
+                closeRun(static_cast<uint8_t>(run + 1));
+            }
+            if (byte == 0)
+            {
+                if (V == Variant::Zpe && run <= zpeMaxPairRunLength)
+                {
+                    // Might be a pair, depends on the next byte
+                    zeroPending = true;
+                }
+                else
+                {
+                    closeRun(static_cast<uint8_t>(run + 1));
+                }
+                return;
+            }
+            out(written++) = byte;
+            if (++run == maxRunLengthOf<V>)
+            {
+                // No implicit zero, the next header continues the run
+                out(header) = static_cast<uint8_t>(run + 1);
+                open = false;
+            }
+        }
+
+        template<std::ranges::input_range Bytes>
+        void push(const Bytes & bytes)
+        {
+            for (const auto byte : bytes)
+            {
+                push(byte);
+            }
+        }
+
+        /// Fills in the last header, returning the encoded size. Like
+        /// `encode` this doesn't add the zero delimiter.
+        size_t finish()
+        {
+            if (V == Variant::Zpe && zeroPending)
+            {
+                // The second zero is the implicit one at the end
+                out(header) = static_cast<uint8_t>(zpePairHeader + run);
+            }
+            else if (open)
+            {
+                out(header) = static_cast<uint8_t>(run + 1);
+                if (V == Variant::CobsR && run > 0 && out(written - 1) >= out(header))
+                {
+                    // The last byte stands in for the header
+                    out(header) = out(--written);
+                }
+            }
+            return written;
+        }
+
+    private:
+        /// Writes the header of a run ended by a zero (or pair), and
+        /// starts the next one.
+        void closeRun(uint8_t value)
+        {
+            out(header) = value;
+            header = written++;
+            run = 0;
+        }
+
+        Out out;
+        size_t header = 0;
+        size_t written = 1;
+        uint8_t run = 0;
+        bool open = true;
+        /// COBS/ZPE: a zero after a short run, which might be a pair
+        bool zeroPending = false;
+    };
 
     /// Decodes data as a state-machine.
+    template<Variant V = Variant::Cobs>
     class Decoder
     {
     public:
-        /// Feeds a character to the state-machine, returning whether that
-        /// character is to be emitted, or only causing an internal transition
-        bool feed(uint8_t byte);
+        /// Result of decoding a block of wire bytes, see `decode`.
+        struct Result
+        {
+            /// Number of bytes of `in` used, including the delimiter.
+            size_t consumed;
+            /// Number of decoded bytes put into `out`.
+            size_t written;
+            /// Whether `in[consumed - 1]` was a zero delimiter, i.e. the
+            /// frame is complete.
+            bool frameEnd;
+            /// See `truncated`, only set with `frameEnd`.
+            bool truncated = false;
+        };
 
-        /// Get the current character, should be called before feed, with the
-        /// same byte that will be fed. But it is only valid if `feed` returns
-        /// true, otherwise it should be ignored.
-        uint8_t get(uint8_t byte) const;
+        /// Decodes wire bytes a block at a time, stopping after the end of
+        /// a frame, or when `in` is used up or `out` is full. Whole runs
+        /// are copied at once (the run header says how many literal bytes
+        /// follow), so this is much faster than `feed` per byte.
+        ///
+        /// Shares state with `feed`, so a frame can be split over calls.
+        Result decode(std::span<const uint8_t> in, std::span<uint8_t> out);
+
+        /// Feeds a wire byte to the state-machine, calling `emit(uint8_t)`
+        /// for each decoded byte it results in (none for headers without
+        /// pending zeros, two for COBS/ZPE zero pairs). Returns true for
+        /// the zero delimiter, i.e. at the end of the frame.
+        template<typename Emit>
+        bool feed(uint8_t byte, Emit && emit)
+        {
+            if (byte == 0)
+            {
+                frameTruncated = false;
+                // The last implicit zero of a frame is not data, but for
+                // COBS/R a run cut short was ended by its header value
+                if (runLength == 0)
+                {
+                    for (; zeros > 1; --zeros)
+                    {
+                        emit(0);
+                    }
+                }
+                else if constexpr (V == Variant::CobsR)
+                {
+                    emit(header);
+                }
+                else
+                {
+                    frameTruncated = true;
+                }
+                reset();
+                return true;
+            }
+            else if (runLength == 0)
+            {
+                // Zeros from the previous run are only output now, as the
+                // last one in a frame is dropped
+                for (; zeros > 0; --zeros)
+                {
+                    emit(0);
+                }
+                start(byte);
+            }
+            else
+            {
+                --runLength;
+                emit(byte);
+            }
+            return false;
+        }
+
+        /// Whether the frame which just ended had a run header pointing
+        /// past the delimiter, i.e. it was truncated or corrupted. (Not
+        /// detectable for COBS/R, where that is how the frame ends.)
+        bool truncated() const { return frameTruncated; }
 
     private:
+        /// Sets up the state for a run with the given header.
+        void start(uint8_t byte)
+        {
+            header = byte;
+            if (V == Variant::Zpe && byte >= zpePairHeader)
+            {
+                runLength = byte - zpePairHeader;
+                zeros = 2;
+            }
+            else
+            {
+                runLength = byte - 1;
+                zeros = runLength == maxRunLengthOf<V> ? 0 : 1;
+            }
+        }
+
+        void reset()
+        {
+            runLength = 0;
+            zeros = 0;
+        }
+
+        /// Literal bytes left in the current run.
         uint8_t runLength = 0;
-        bool runLengthWasMax = true;
+        /// Zeros to output before the next run.
+        uint8_t zeros = 0;
+        /// Header of the current run.
+        uint8_t header = 0;
+        bool frameTruncated = false;
     };
 };
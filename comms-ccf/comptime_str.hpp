@@ -23,7 +23,7 @@ struct CompTimeString
 {
     static constexpr size_t size = Size;
 
-    operator std::string_view() const { return std::string_view{buf.data(), Size - 1}; }
+    constexpr operator std::string_view() const { return std::string_view{buf.data(), Size - 1}; }
 
     constexpr CompTimeString() { }
     constexpr CompTimeString(const char (&buf_)[Size])
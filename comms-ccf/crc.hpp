@@ -0,0 +1,211 @@
+/**
+\file
+\brief CRC-32C and CRC-16 checksums, alternatives to [FNV-1A](#fnv1a.hpp).
+
+# CRC checksums
+
+FNV-1A needs a multiply per byte, each depending on the last, so it can't
+go faster than about a byte per cycle. That is plenty for a UART, but not
+for e.g. a host gateway checking every byte of many device streams. CRCs
+can work on several bytes at a time, either with bigger tables or with
+hardware support, and also have better guarantees for burst errors.
+
+## CRC-32C
+
+The Castagnoli CRC (reflected polynomial 0x82F63B78, initial value and
+final XOR 0xFFFFFFFF), as used by iSCSI, ext4 and others. The byte-wise
+`feed` uses one 256 entry table, `checksum` uses the slicing-by-8 method
+with eight tables (8 KiB, so it is more for hosts than for
+microcontrollers). On x86 with SSE4.2 (`-msse4.2`) or ARMv8 with the CRC
+extension (`-march=armv8-a+crc`) there is also `checksumHw`, which uses
+the CRC32C instructions.
+
+## CRC-16
+
+CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF, not
+reflected, no final XOR), e.g. Python's `binascii.crc_hqx(data, 0xFFFF)`.
+Only two bytes on the wire, for slow links where every byte counts, with a
+512 byte table.
+
+Both go on the wire little endian, like the FNV-1A hash.
+
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <span>
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+namespace Crc32c
+{
+    constexpr uint32_t polynomial = 0x82F63B78;
+    constexpr uint32_t initialCrc = 0xFFFFFFFF;
+    constexpr size_t size = sizeof(initialCrc);
+
+    /// Whether `checksumHw` is available for the target.
+#if defined(__SSE4_2__) || defined(__ARM_FEATURE_CRC32)
+    constexpr bool hasHardware = true;
+#else
+    constexpr bool hasHardware = false;
+#endif
+
+    /// `tables[0]` is the usual byte at a time table, `tables[k]` is the
+    /// CRC of a byte followed by `k` zero bytes, for slicing-by-8.
+    constexpr std::array<std::array<uint32_t, 256>, 8> makeTables()
+    {
+        std::array<std::array<uint32_t, 256>, 8> tables{};
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                crc = (crc >> 1) ^ ((crc & 1) ? polynomial : 0);
+            }
+            tables[0][i] = crc;
+        }
+        for (size_t k = 1; k < tables.size(); ++k)
+        {
+            for (size_t i = 0; i < 256; ++i)
+            {
+                const uint32_t prev = tables[k - 1][i];
+                tables[k][i] = (prev >> 8) ^ tables[0][prev & 0xFF];
+            }
+        }
+        return tables;
+    }
+
+    inline constexpr auto tables = makeTables();
+
+    /// Update the CRC with the given byte.
+    constexpr uint32_t feed(uint32_t crc, uint8_t byte)
+    {
+        return (crc >> 8) ^ tables[0][(crc ^ byte) & 0xFF];
+    }
+
+    constexpr uint32_t load32(const uint8_t * p)
+    {
+        return
+            (static_cast<uint32_t>(p[0]) <<  0) |
+            (static_cast<uint32_t>(p[1]) <<  8) |
+            (static_cast<uint32_t>(p[2]) << 16) |
+            (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    /// Update the CRC over the given span, eight bytes at a time.
+    constexpr uint32_t checksum(std::span<const uint8_t> span, uint32_t crc = initialCrc)
+    {
+        const uint8_t * p = span.data();
+        size_t len = span.size();
+        for (; len >= 8; len -= 8, p += 8)
+        {
+            const uint32_t lo = load32(p) ^ crc;
+            const uint32_t hi = load32(p + 4);
+            crc =
+                tables[7][(lo >>  0) & 0xFF] ^
+                tables[6][(lo >>  8) & 0xFF] ^
+                tables[5][(lo >> 16) & 0xFF] ^
+                tables[4][(lo >> 24) & 0xFF] ^
+                tables[3][(hi >>  0) & 0xFF] ^
+                tables[2][(hi >>  8) & 0xFF] ^
+                tables[1][(hi >> 16) & 0xFF] ^
+                tables[0][(hi >> 24) & 0xFF];
+        }
+        for (; len > 0; --len, ++p)
+        {
+            crc = feed(crc, *p);
+        }
+        return crc;
+    }
+
+#if defined(__SSE4_2__) || defined(__ARM_FEATURE_CRC32)
+    /// Same as `feed`, using the CRC32C instruction.
+    inline uint32_t feedHw(uint32_t crc, uint8_t byte)
+    {
+#if defined(__SSE4_2__)
+        return _mm_crc32_u8(crc, byte);
+#else
+        return __crc32cb(crc, byte);
+#endif
+    }
+
+    /// Same as `checksum`, using the CRC32C instruction eight bytes at a
+    /// time.
+    inline uint32_t checksumHw(std::span<const uint8_t> span, uint32_t crc = initialCrc)
+    {
+        const uint8_t * p = span.data();
+        size_t len = span.size();
+        for (; len >= 8; len -= 8, p += 8)
+        {
+            const uint64_t word = load32(p) | (static_cast<uint64_t>(load32(p + 4)) << 32);
+#if defined(__SSE4_2__) && defined(__x86_64__)
+            crc = static_cast<uint32_t>(_mm_crc32_u64(crc, word));
+#elif defined(__SSE4_2__)
+            crc = _mm_crc32_u32(crc, static_cast<uint32_t>(word));
+            crc = _mm_crc32_u32(crc, static_cast<uint32_t>(word >> 32));
+#else
+            crc = __crc32cd(crc, word);
+#endif
+        }
+        for (; len > 0; --len, ++p)
+        {
+            crc = feedHw(crc, *p);
+        }
+        return crc;
+    }
+#endif
+
+    /// The final CRC value, as sent.
+    constexpr uint32_t final(uint32_t crc)
+    {
+        return ~crc;
+    }
+};
+
+namespace Crc16
+{
+    constexpr uint16_t polynomial = 0x1021;
+    constexpr uint16_t initialCrc = 0xFFFF;
+    constexpr size_t size = sizeof(initialCrc);
+
+    constexpr std::array<uint16_t, 256> makeTable()
+    {
+        std::array<uint16_t, 256> table{};
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint16_t crc = static_cast<uint16_t>(i << 8);
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                crc = static_cast<uint16_t>((crc << 1) ^ ((crc & 0x8000) ? polynomial : 0));
+            }
+            table[i] = crc;
+        }
+        return table;
+    }
+
+    inline constexpr auto table = makeTable();
+
+    /// Update the CRC with the given byte.
+    constexpr uint16_t feed(uint16_t crc, uint8_t byte)
+    {
+        return static_cast<uint16_t>((crc << 8) ^ table[((crc >> 8) ^ byte) & 0xFF]);
+    }
+
+    /// Compute the CRC over the given span.
+    constexpr uint16_t checksum(std::span<const uint8_t> span, uint16_t crc = initialCrc)
+    {
+        for (auto c : span)
+        {
+            crc = feed(crc, c);
+        }
+        return crc;
+    }
+};
@@ -18,7 +18,9 @@ that). So it isn't used for signing, only to detect errors.
 
 For a simple comparison of other hashes, see
 test/hash_comparison.py but for a much better one see
-https://softwareengineering.stackexchange.com/a/145633
+https://softwareengineering.stackexchange.com/a/145633 (and
+test/bench_checksum.cpp for speed and error rates against the CRCs in
+[checksums](#checksum.hpp)).
 
 */
 
@@ -33,7 +35,10 @@ https://softwareengineering.stackexchange.com/a/145633
 #include <stddef.h>
 #include <stdint.h>
 
+#include <algorithm>
+#include <array>
 #include <span>
+#include <string_view>
 
 namespace Fnv1a
 {
@@ -59,6 +64,27 @@ namespace Fnv1a
         return hash;
     }
 
+    /// Compute the hash over the characters of a string, e.g. a name.
+    constexpr uint32_t checksum(std::string_view str, uint32_t hash = initialHash)
+    {
+        for (auto c : str)
+        {
+            hash = feed(hash, static_cast<uint8_t>(c));
+        }
+        return hash;
+    }
+
+    /// The hash as it goes on the wire (little endian).
+    constexpr std::array<uint8_t, size> bytes(uint32_t hash)
+    {
+        return {
+            static_cast<uint8_t>(hash >>  0),
+            static_cast<uint8_t>(hash >>  8),
+            static_cast<uint8_t>(hash >> 16),
+            static_cast<uint8_t>(hash >> 24),
+        };
+    }
+
     /// Computes the hash on span[:-4] and places it at the end of
     /// the span.
     template<size_t Size>
@@ -69,11 +95,8 @@ namespace Fnv1a
         {
             return;
         }
-        const uint32_t got = checksum(span.first(end - 4), hash);
-        span[end - 4] = static_cast<uint8_t>(got >>  0);
-        span[end - 3] = static_cast<uint8_t>(got >>  8);
-        span[end - 2] = static_cast<uint8_t>(got >> 16);
-        span[end - 1] = static_cast<uint8_t>(got >> 24);
+        const auto got = bytes(checksum(span.first(end - 4), hash));
+        std::ranges::copy(got, span.last(4).begin());
     }
 
     /// Checks that the span[:-4] sums to the same has as is stored
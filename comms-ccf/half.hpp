@@ -0,0 +1,127 @@
+/**
+\file
+\brief Software IEEE 754 half float (binary16) conversion.
+
+# Half floats
+
+CBOR sends floats in the smallest of half, single or double precision that
+holds them exactly, so e.g. 1.5 or 100.0 take 3 bytes rather than 5. With
+`_Float16` the compiler does the conversion (in hardware on some targets),
+but many toolchains (e.g. arm-none-eabi for a Cortex-M3) don't have it, so
+these do it with integer operations instead:
+
+- `fromFloat` rounds a float or double to the nearest half (ties to even,
+  like the hardware), overflowing to infinity, rounding to subnormals or
+  zero below the normal range, and keeping NaNs quiet NaNs.
+- `toFloat` is exact, every half is a float.
+
+They are bit patterns (`uint16_t`) rather than a type, as that is all CBOR
+needs.
+
+*/
+
+#pragma once
+
+#include "types.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <bit>
+#include <concepts>
+#include <limits>
+
+namespace Half
+{
+    /// The NaN sent for any NaN, as `static_cast<_Float16>(NAN)`
+    constexpr uint16_t quietNan = 0x7E00;
+    constexpr uint16_t infinity = 0x7C00;
+    constexpr uint16_t signBit = 0x8000;
+    constexpr int mantissaBits = 10;
+    constexpr int bias = 15;
+
+    /// `value >> shift` rounded to nearest, ties to even.
+    template<std::unsigned_integral Bits>
+    constexpr Bits roundShift(Bits value, int shift)
+    {
+        const Bits halfway = Bits{1} << (shift - 1);
+        const Bits rest = value & ((Bits{1} << shift) - 1);
+        const Bits out = value >> shift;
+        return (rest > halfway || (rest == halfway && (out & 1))) ? out + 1 : out;
+    }
+
+    /// The half nearest to `value`.
+    template<typename F> requires std::same_as<F, float> || std::same_as<F, double>
+    constexpr uint16_t fromFloat(F value)
+    {
+        using Bits = UintT<sizeof(F) * 8>;
+        constexpr int width = sizeof(F) * 8;
+        constexpr int mantissa = std::numeric_limits<F>::digits - 1;
+        constexpr int exponentMask = (1 << (width - 1 - mantissa)) - 1;
+        constexpr int fromBias = exponentMask >> 1;
+
+        const Bits bits = std::bit_cast<Bits>(value);
+        const auto sign = static_cast<uint16_t>((bits >> (width - 16)) & signBit);
+        const int exponent = static_cast<int>((bits >> mantissa) & exponentMask);
+        Bits fraction = bits & ((Bits{1} << mantissa) - 1);
+
+        if (exponent == exponentMask)
+        {
+            // Infinity, or NaN keeping the top of the payload but quiet
+            const auto payload = static_cast<uint16_t>(fraction >> (mantissa - mantissaBits));
+            return sign | infinity | (fraction != 0 ? (quietNan & ~infinity) | payload : 0);
+        }
+        const int halfExponent = exponent - fromBias + bias;
+        if (halfExponent >= 0x1F)
+        {
+            return sign | infinity;
+        }
+        if (halfExponent <= 0)
+        {
+            // Below half of the smallest subnormal (2^-25), including
+            // zeros and the float's own subnormals
+            if (halfExponent < -mantissaBits)
+            {
+                return sign;
+            }
+            // Subnormal, with the implicit bit made explicit. Rounding up
+            // to 0x400 is the smallest normal, which is right.
+            fraction |= Bits{1} << mantissa;
+            return sign | static_cast<uint16_t>(
+                roundShift(fraction, mantissa - mantissaBits + 1 - halfExponent));
+        }
+        // Rounding up can carry into the exponent, which is also right,
+        // up to infinity for 65520 and above
+        const Bits combined = (static_cast<Bits>(halfExponent) << mantissa) | fraction;
+        return sign | static_cast<uint16_t>(roundShift(combined, mantissa - mantissaBits));
+    }
+
+    /// The float equal to the half `bits`.
+    constexpr float toFloat(uint16_t bits)
+    {
+        constexpr int floatBias = 127;
+        constexpr int shift = std::numeric_limits<float>::digits - 1 - mantissaBits;
+        const uint32_t sign = static_cast<uint32_t>(bits & signBit) << 16;
+        const uint32_t exponent = (bits >> mantissaBits) & 0x1F;
+        uint32_t fraction = bits & ((1u << mantissaBits) - 1);
+
+        if (exponent == 0x1F)
+        {
+            return std::bit_cast<float>(sign | 0x7F800000u | (fraction << shift));
+        }
+        if (exponent == 0)
+        {
+            if (fraction == 0)
+            {
+                return std::bit_cast<float>(sign);
+            }
+            // Subnormal, normalise so the top bit is the implicit one
+            const int leading = std::countl_zero(fraction) - (31 - mantissaBits);
+            fraction = (fraction << leading) & ((1u << mantissaBits) - 1);
+            const auto floatExponent = static_cast<uint32_t>(floatBias - bias + 1 - leading);
+            return std::bit_cast<float>(sign | (floatExponent << 23) | (fraction << shift));
+        }
+        return std::bit_cast<float>(
+            sign | ((exponent + floatBias - bias) << 23) | (fraction << shift));
+    }
+};
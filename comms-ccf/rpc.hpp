@@ -19,12 +19,38 @@ even before we send data out.
 
 Using template metaprogramming, we can also have type safety in C++.
 
+## Calling by name
+
+Functions are numbered by their position (from 1, 0 is the schema), which
+changes when the firmware adds or reorders functions. So a client can also
+call function `Rpc::hashedFunction` (0xFF) with the [FNV-1A](#fnv1a.hpp)
+hash of the name (4 bytes, little endian) before the arguments. This
+doesn't need the schema, and stays the same between builds.
+
+The hashes are looked up in a perfect hash table. Declaring the `Rpc` as
+`RPC_CONSTINIT` builds that table at compile time, which also makes two
+names with the same hash a compile error. (Except for `INLINE_VTABLE`,
+where `RPC_CONSTINIT` is empty and the table is built at startup.)
+
+## Type tables
+
+Each `Call` signature instantiates its own argument decoding, `std::apply`
+and return encoding, so every new signature costs hundreds of bytes of
+flash. Compiling with `RPC_TYPE_TABLES` instead describes the argument and
+return types as a constexpr table of `Cbor::Erased::Type` bytes, decoded
+and encoded by the shared `Cbor::Erased::call` in cbor.cpp, leaving only a
+small `invoke` per signature. This only applies to signatures of the
+simple types (integers, `bool`, `float`, `double`, `std::string_view` and
+`std::span<uint8_t>`), others (e.g. structs or ranges) use the templated
+code as before. It is the same on the wire either way.
+
 */
 
 #pragma once
 
 #include "cbor.hpp"
 #include "comptime_str.hpp"
+#include "fnv1a.hpp"
 
 #if defined(DEBUG_RPC)
 #include DEBUG_RPC
@@ -36,7 +62,9 @@ Using template metaprogramming, we can also have type safety in C++.
 #include <stdint.h>
 
 #include <array>
+#include <bit>
 #include <functional>
+#include <ranges>
 #include <span>
 #include <string_view>
 #include <tuple>
@@ -48,12 +76,16 @@ Using template metaprogramming, we can also have type safety in C++.
 #define self_app(value) value,
 #define prototype(ret, name, args) const ret (*name) args
 #define definition(ret, name, args) static ret name args
+/// Can't build the vtable at compile time (see the reinterpret_cast)
+#define RPC_CONSTINIT
 #else
 #define self (*this)
 #define self_arg(type) /* implicit */
 #define self_app(value) /* implicit */
 #define prototype(ret, name, args) virtual ret name args const = 0
 #define definition(ret, name, args) ret name args const override
+/// Use on the `Rpc` declaration to build it at compile time
+#define RPC_CONSTINIT constinit
 #endif
 
 #define LITERAL_COMPTIME_STRING(name, value) const decltype(CompTimeString{value}) name{value}
@@ -69,6 +101,24 @@ struct Type<std::string_view> { static constexpr CompTimeString python = "str";
 template<size_t extent>
 struct Type<std::span<uint8_t, extent>> { static constexpr CompTimeString python = "bytes"; };
 
+template<typename T, size_t extent>
+struct Type<Cbor::TypedArray<T, extent>> { static constexpr CompTimeString python = "array"; };
+
+/// The host decodes deltas as signed unless the hint says otherwise
+template<std::signed_integral I>
+struct Type<Cbor::Deltas<I>> { static constexpr CompTimeString python = "list[int]"; };
+
+template<std::unsigned_integral I>
+struct Type<Cbor::Deltas<I>> { static constexpr CompTimeString python = "list[uint]"; };
+
+template<std::ranges::input_range R>
+struct Type<R>
+{
+    constexpr static CompTimeString python{
+        CompTimeString{"list["} + Type<std::ranges::range_value_t<R>>::python + CompTimeString{"]"}
+    };
+};
+
 template<>
 struct Type<std::tuple<>> { static constexpr CompTimeString python{"tuple[()]"}; };
 template<typename... Ts>
@@ -81,16 +131,51 @@ struct Type<std::tuple<Ts...>>
     };
 };
 
+/// Structs are sent as a tuple of their fields, or a dict by field index
+template<Aggregate::Reflectable T> requires (!Cbor::aggregateAsMap<T>)
+struct Type<T> { static constexpr CompTimeString python = Type<Aggregate::Fields<T>>::python; };
+
+template<Aggregate::Reflectable T> requires Cbor::aggregateAsMap<T>
+struct Type<T> { static constexpr CompTimeString python{"dict[int, Any]"}; };
+
 class NonTemplatedCall
 {
 public:
     /// Encodes the schema for the function into `seq`.
-    prototype(bool, schema, (self_arg(NonTemplatedCall) Cbor::Sequence<Cbor::Major::Array> & seq));
+    prototype(bool, schema, (self_arg(NonTemplatedCall) Cbor::Sequence<Cbor::Major::Array, Cbor::SinkRef> & seq));
     /// Calls this function with the encoded args in `args` and encodes
-    /// the return into `ret`.
-    prototype(bool, call, (self_arg(NonTemplatedCall) std::span<uint8_t> & args, std::span<uint8_t> & ret));
+    /// the return into `ret` (e.g. straight into the TX queue, see
+    /// `Ccf::poll`). Nothing is written to `ret` until the function has
+    /// returned, so it can use the TX queue itself (e.g. to log).
+    prototype(bool, call, (self_arg(NonTemplatedCall) std::span<uint8_t> & args, Cbor::SinkRef & ret));
 };
 
+/// The schema of a call with `RPC_TYPE_TABLES`, shared by every
+/// signature. `python` is the return type then the argument types.
+inline bool erasedSchema(
+    Cbor::Sequence<Cbor::Major::Array, Cbor::SinkRef> & seq,
+    const char * name,
+    const char * doc,
+    std::span<const char * const> argNames,
+    std::span<const std::string_view> python)
+{
+    Cbor::Sequence<Cbor::Major::Array, Cbor::SinkRef> subseq(seq, 3 + 2 * argNames.size());
+    if (!subseq.encode(std::string_view(name)) ||
+        !subseq.encode(std::string_view(doc)) ||
+        !subseq.encode(python[0]))
+    {
+        return false;
+    }
+    for (size_t i = 0; i < argNames.size(); ++i)
+    {
+        if (!subseq.encode(std::string_view(argNames[i])) || !subseq.encode(python[1 + i]))
+        {
+            return false;
+        }
+    }
+    return subseq.as_expected();
+}
+
 template<typename Ret, typename... Args>
 class Call : public NonTemplatedCall
 {
@@ -98,8 +183,17 @@ public:
     using Fun = Ret (*)(Args...);
     using ArgsTup = std::tuple<Args...>;
     using Return = Ret;
+    /// Most bytes the return value can encode to, or 0 if it isn't
+    /// bounded (e.g. strings), so only checked when encoding.
+    static constexpr size_t maxReturnSize = [] {
+        if constexpr (Cbor::Bounded<Ret>)
+        {
+            return Cbor::Cbor<Ret>::maxSize();
+        }
+        return size_t{0};
+    }();
 
-    Call(
+    constexpr Call(
         const char * name_,
         const char * doc_,
         std::array<const char *, sizeof...(Args)> argNames_,
@@ -118,30 +212,52 @@ public:
           name(name_),
           doc(doc_),
           argNames(argNames_),
-          ptr(ptr_) { }
+          ptr(ptr_),
+          hash(Fnv1a::checksum(std::string_view(name_))) { }
 
-    definition(bool, schema, (self_arg(Call) Cbor::Sequence<Cbor::Major::Array> & seq))
+    /// The FNV-1A hash of the name, to call it by name.
+    constexpr uint32_t nameHash() const { return hash; }
+
+    /// Whether this goes through the shared, type-erased code (see
+    /// `RPC_TYPE_TABLES`), only possible if every type has a
+    /// `Cbor::Erased::Type`.
+    static constexpr bool erased =
+#if defined(RPC_TYPE_TABLES)
+        Cbor::Erased::Describable<Cbor::WrapVoidT<Ret, Cbor::Undefined>> &&
+        (Cbor::Erased::Describable<Args> && ...);
+#else
+        false;
+#endif
+
+    definition(bool, schema, (self_arg(Call) Cbor::Sequence<Cbor::Major::Array, Cbor::SinkRef> & seq))
     {
-        Cbor::Sequence<Cbor::Major::Array> subseq(seq, 3 + 2 * sizeof...(Args));
-        return
-            subseq.encode(std::string_view(self.name)) &&
-            subseq.encode(std::string_view(self.doc)) &&
-            subseq.encode(static_cast<std::string_view>(Type<Return>::python)) &&
-            [&]<size_t... Idx>(std::index_sequence<Idx...>)
-            {
-                return (
-                    (
-                        subseq.encode(std::string_view(self.argNames[Idx])) &&
-                        subseq.encode(static_cast<std::string_view>(
-                            Type<std::tuple_element_t<Idx, ArgsTup>>::python))
-                    ) &&
-                    ...
-                );
-            }(std::index_sequence_for<Args...>{}) &&
-            subseq.as_expected();
+        if constexpr (erased)
+        {
+            return erasedSchema(seq, self.name, self.doc, self.argNames, python());
+        }
+        else
+        {
+            Cbor::Sequence<Cbor::Major::Array, Cbor::SinkRef> subseq(seq, 3 + 2 * sizeof...(Args));
+            return
+                subseq.encode(std::string_view(self.name)) &&
+                subseq.encode(std::string_view(self.doc)) &&
+                subseq.encode(static_cast<std::string_view>(Type<Return>::python)) &&
+                [&]<size_t... Idx>(std::index_sequence<Idx...>)
+                {
+                    return (
+                        (
+                            subseq.encode(std::string_view(self.argNames[Idx])) &&
+                            subseq.encode(static_cast<std::string_view>(
+                                Type<std::tuple_element_t<Idx, ArgsTup>>::python))
+                        ) &&
+                        ...
+                    );
+                }(std::index_sequence_for<Args...>{}) &&
+                subseq.as_expected();
+        }
     }
 
-    definition(bool, call, (self_arg(Call) std::span<uint8_t> & args, std::span<uint8_t> & ret))
+    definition(bool, call, (self_arg(Call) std::span<uint8_t> & args, Cbor::SinkRef & ret))
     {
         if (self.ptr == nullptr)
         {
@@ -154,27 +270,93 @@ public:
             debugf(" %02X", byte);
         }
         debugf(END);
-        auto argsTup = Cbor::Cbor<ArgsTup>::decode(args);
-        if (argsTup)
+        if constexpr (erased)
         {
-            debugf(DEBUG "function is %p" END LOGLEVEL_ARGS, self.ptr);
-            auto retVal = Cbor::WrapVoid<Ret, Cbor::Undefined>{self.ptr, *argsTup};
-            return Cbor::Cbor<Ret>::encode(retVal.value, ret);
+            std::array<Cbor::Erased::Value, sizeof...(Args)> values;
+            return Cbor::Erased::call(
+                signature(), reinterpret_cast<void (*)()>(self.ptr), values.data(), args, ret);
+        }
+        else
+        {
+            // Decoded in place, so the arguments are only on the stack once
+            ArgsTup argsTup{};
+            if (Cbor::Cbor<ArgsTup>::decodeInto(argsTup, args))
+            {
+                debugf(DEBUG "function is %p" END LOGLEVEL_ARGS, self.ptr);
+                // Returned before anything is encoded into `ret`
+                auto retVal = Cbor::WrapVoid<Ret, Cbor::Undefined>{self.ptr, std::move(argsTup)};
+                return Cbor::Cbor<Ret>::encode(retVal.value, ret);
+            }
+            return false;
         }
-        return false;
     }
 private:
+    /// The types as a table for `Cbor::Erased::call`, leaving this as
+    /// the only code per signature.
+    static Cbor::Erased::Value invoke(void (*fn)(), const Cbor::Erased::Value * values)
+    {
+        return [&]<size_t... Idx>(std::index_sequence<Idx...>)
+        {
+            const auto function = reinterpret_cast<Fun>(fn);
+            if constexpr (std::is_void_v<Ret>)
+            {
+                function(Cbor::Erased::get<Args>(values[Idx])...);
+                return Cbor::Erased::Value{};
+            }
+            else
+            {
+                return Cbor::Erased::wrap(function(Cbor::Erased::get<Args>(values[Idx])...));
+            }
+        }(std::index_sequence_for<Args...>{});
+    }
+    static const Cbor::Erased::Signature & signature()
+    {
+        static constexpr std::array<Cbor::Erased::Type, sizeof...(Args)> types{
+            Cbor::Erased::typeOf<Args>...
+        };
+        static constexpr Cbor::Erased::Signature table{
+            Cbor::Erased::typeOf<Cbor::WrapVoidT<Ret, Cbor::Undefined>>, types, &invoke,
+        };
+        return table;
+    }
+    static std::span<const std::string_view> python()
+    {
+        static constexpr std::array<std::string_view, 1 + sizeof...(Args)> types{
+            std::string_view{Type<Return>::python},
+            std::string_view{Type<Args>::python}...
+        };
+        return types;
+    }
+
     const char * name;
     const char * doc;
     std::array<const char *, sizeof...(Args)> argNames;
     Fun ptr;
+    uint32_t hash;
 };
 
+/// Not constexpr, so two names with the same hash in an `RPC_CONSTINIT`
+/// table are a compile error. Otherwise only the first of them can be
+/// called by name.
+inline void rpcNameHashCollision(const char * reason)
+{
+    debugf(ERROR "%s, only callable by number" END LOGLEVEL_ARGS, reason);
+}
+
 template<typename... Calls>
 class Rpc
 {
 public:
-    Rpc(Calls && ... calls_)
+    /// Function number for calling by the hash of the name, see
+    /// [calling by name](#rpc.hpp).
+    static constexpr uint8_t hashedFunction = 0xFF;
+    static_assert(sizeof...(Calls) < hashedFunction, "Too many RPC functions");
+
+    /// The most any (bounded) return value encodes to, which
+    /// `Ccf::poll` checks fits in a packet.
+    static constexpr size_t maxReturnSize = std::max({size_t{0}, Calls::maxReturnSize...});
+
+    constexpr Rpc(Calls && ... calls_)
     : tuple{std::forward<Calls>(calls_)...},
       calls{
           [&]<size_t... Idx>(std::index_sequence<Idx...>)
@@ -184,32 +366,79 @@ public:
                   *static_cast<NonTemplatedCall *>(&std::get<Idx>(tuple))})...
               };
           }(std::index_sequence_for<Calls...>{})
-      } { }
+      },
+      hashes{
+          [&]<size_t... Idx>(std::index_sequence<Idx...>)
+          {
+              return std::array<uint32_t, sizeof...(Calls)>{std::get<Idx>(tuple).nameHash()...};
+          }(std::index_sequence_for<Calls...>{})
+      }
+    {
+        buildTable();
+    }
 
     /// Encode the schema for all the RPC functions onto buf.
-    bool schema(std::span<uint8_t> & buf) const
+    bool schema(Cbor::SinkRef & buf) const
     {
-        Cbor::Sequence<Cbor::Major::Array> seq(buf, sizeof...(Calls));
+        Cbor::Sequence<Cbor::Major::Array, Cbor::SinkRef> seq(buf, sizeof...(Calls));
         for (auto & c : calls)
         {
             auto & call = c.get();
             if (!call.schema(self_app(call) seq))
             {
-                debugf(WARN "Schema failed to encode (buf size %zu)" END LOGLEVEL_ARGS, buf.size());
+                debugf(WARN "Schema failed to encode" END LOGLEVEL_ARGS);
                 return false;
             }
         }
         return seq.as_expected();
     }
+    bool schema(std::span<uint8_t> & buf) const
+    {
+        Cbor::SinkRef sink{buf};
+        return schema(sink);
+    }
 
-    /// Calls the given RPC function (by index n) using the encoded
-    /// arguments in `args` and encodes the result into `ret`.
-    bool call(size_t n, std::span<uint8_t> & args, std::span<uint8_t> & ret) const
+    /// The function with the given name hash, or nullptr.
+    NonTemplatedCall * find(uint32_t hash) const
+    {
+        const uint8_t entry = table[slot(hash, seed)];
+        if (entry == 0 || hashes[entry - 1] != hash)
+        {
+            return nullptr;
+        }
+        return &calls[entry - 1].get();
+    }
+
+    /// Calls the given RPC function (by index n, or by name hash for
+    /// `hashedFunction`) using the encoded arguments in `args` and
+    /// encodes the result into `ret`.
+    bool call(size_t n, std::span<uint8_t> & args, Cbor::SinkRef & ret) const
     {
         if (n == 0)
         {
             return schema(ret);
         }
+        else if (n == hashedFunction)
+        {
+            if (args.size() < sizeof(uint32_t))
+            {
+                debugf(WARN "Missing function name hash" END LOGLEVEL_ARGS);
+                return false;
+            }
+            const uint32_t hash =
+                (static_cast<uint32_t>(args[0]) <<  0) |
+                (static_cast<uint32_t>(args[1]) <<  8) |
+                (static_cast<uint32_t>(args[2]) << 16) |
+                (static_cast<uint32_t>(args[3]) << 24);
+            args = args.subspan(sizeof(hash));
+            auto * call = find(hash);
+            if (call == nullptr)
+            {
+                debugf(WARN "No function with name hash %08X" END LOGLEVEL_ARGS, hash);
+                return false;
+            }
+            return call->call(self_app(*call) args, ret);
+        }
         else if (n < sizeof...(Calls) + 1)
         {
             auto & call = calls[n-1].get();
@@ -221,9 +450,66 @@ public:
             return false;
         }
     }
+    bool call(size_t n, std::span<uint8_t> & args, std::span<uint8_t> & ret) const
+    {
+        Cbor::SinkRef sink{ret};
+        return call(n, args, sink);
+    }
 
     std::tuple<Calls...> tuple;
     std::array<std::reference_wrapper<NonTemplatedCall>, sizeof...(Calls)> calls;
+
+private:
+    /// At least twice the functions, so a seed is quick to find
+    static constexpr size_t tableSize = std::bit_ceil(2 * sizeof...(Calls) + 1);
+
+    static constexpr size_t slot(uint32_t hash, uint32_t seed)
+    {
+        // Mix the bits, so a different seed moves every hash
+        uint32_t x = hash ^ seed;
+        x ^= x >> 16;
+        x *= 0x7FEB352D;
+        x ^= x >> 15;
+        return x & (tableSize - 1);
+    }
+
+    /// Finds a seed where every hash gets its own slot.
+    constexpr void buildTable()
+    {
+        for (size_t i = 0; i < hashes.size(); ++i)
+        {
+            for (size_t j = 0; j < i; ++j)
+            {
+                if (hashes[i] == hashes[j])
+                {
+                    rpcNameHashCollision("Two RPC function names have the same hash");
+                }
+            }
+        }
+        for (seed = 0; seed < 0x10000; ++seed)
+        {
+            table = {};
+            bool ok = true;
+            for (size_t i = 0; ok && i < hashes.size(); ++i)
+            {
+                auto & entry = table[slot(hashes[i], seed)];
+                ok = entry == 0 || hashes[entry - 1] == hashes[i];
+                if (entry == 0)
+                {
+                    entry = static_cast<uint8_t>(i + 1);
+                }
+            }
+            if (ok)
+            {
+                return;
+            }
+        }
+        rpcNameHashCollision("No perfect hash for the RPC function names");
+    }
+
+    std::array<uint32_t, sizeof...(Calls)> hashes;
+    std::array<uint8_t, tableSize> table{};
+    uint32_t seed = 0;
 };
 
 // This is a header, undefine the debugf macro
@@ -29,6 +29,6 @@ struct SmallestType
     static constexpr unsigned _bits = std::bit_width(I);
     static constexpr unsigned _bytes = (_bits + 7) / 8;
     static constexpr unsigned N = std::bit_ceil(_bytes);
-    using Type = Uint<N>;
+    using Type = UintT<N * 8>;
 };
 template<size_t I> using SmallestTypeT = SmallestType<I>::Type;
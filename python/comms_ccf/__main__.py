@@ -4,6 +4,7 @@
 Connects to a socket, process, or serial port.
 """
 
+import array
 import asyncio
 import pdb
 import signal
@@ -16,11 +17,12 @@ from pathlib import Path
 from comms_ccf import rtt, serial, stdio, tcp
 from comms_ccf.background import BackgroundTasks
 from comms_ccf.channel import Channels
+from comms_ccf.delta import DeltaSequence
 from comms_ccf.hexdump import hexdump
 from comms_ccf.log import print_logs
 from comms_ccf.repl import Stdio, repl, script
 from comms_ccf.rpc import Rpc
-from comms_ccf.transport import StreamTransport
+from comms_ccf.transport import Checksum, Framing, StreamTransport
 
 console = None
 
@@ -33,8 +35,10 @@ async def demo_rpc(rpc: Rpc):
             print("Exception in demo:", str(e) or repr(e))
 
 
-async def init_locals(rpc: Rpc, debug: bool):
-    while True:
+async def init_locals(rpc: Rpc, debug: bool, discover: bool = True):
+    if not discover:
+        rpc.open()
+    while discover:
         try:
             await rpc.discover()
             break
@@ -47,9 +51,14 @@ async def init_locals(rpc: Rpc, debug: bool):
             time.sleep(0.2)
 
     locals = {k: v for k, v in rpc.methods().items()}
+    # Function number or name, e.g. `_call("add", 2, 3)`
     locals["_call"] = lambda n, *args, **kwargs: rpc(n, args, **kwargs)
     locals["help"] = rpc.help
     locals["hexdump"] = hexdump
+    # For typed arrays, e.g. `array("H", [1, 2, 3])`
+    locals["array"] = array.array
+    # For delta encoded sequences, e.g. `DeltaSequence([1000, 1001, 1003])`
+    locals["DeltaSequence"] = DeltaSequence
     locals["dir"] = lambda: list(locals.keys() - ["__builtins__"])
     locals["locals"] = lambda: {k: v for k, v in locals.items() if k != "__builtins__"}
 
@@ -74,6 +83,26 @@ async def amain():
     parser.add_argument(
         "--debug", "-d", action="store_true", help="Open debugger on exceptions"
     )
+    parser.add_argument(
+        "--no-discover",
+        dest="discover",
+        action="store_false",
+        help="Don't download the schema, only call functions by name with `_call`",
+    )
+    parser.add_argument(
+        "--framing",
+        type=Framing,
+        choices=list(Framing),
+        default=Framing.COBS,
+        help="Framing variant, must match the device's `CcfConfig::framing`",
+    )
+    parser.add_argument(
+        "--checksum",
+        type=Checksum,
+        choices=list(Checksum),
+        default=Checksum.FNV1A,
+        help="Frame checksum, must match the device's `CcfConfig::checksum`",
+    )
     sp = parser.add_subparsers(
         description="Subcommands, see `%(prog)s <subcommand> --help`", required=True
     )
@@ -98,7 +127,13 @@ async def amain():
     async with func(args) as context:
         rx, tx = context
 
-        transport = StreamTransport(rx, tx, log_fp=sys.stderr if args.verbose else None)
+        transport = StreamTransport(
+            rx,
+            tx,
+            log_fp=sys.stderr if args.verbose else None,
+            framing=args.framing,
+            checksum=args.checksum,
+        )
         loop = asyncio.get_event_loop()
         channels = Channels(transport, loop)
         rpc = Rpc(channels)
@@ -112,7 +147,7 @@ async def amain():
             background_tasks.add(channels.loop, args.debug)
 
             if args.repl or args.script_file:
-                locals = await init_locals(rpc, args.debug)
+                locals = await init_locals(rpc, args.debug, args.discover)
                 await demo_rpc(rpc)
 
                 if args.script_file:
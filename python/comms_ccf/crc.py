@@ -0,0 +1,33 @@
+"""
+CRC-32C and CRC-16/CCITT-FALSE, mirrors of comms-ccf/crc.hpp.
+"""
+
+import binascii
+
+CRC32C_POLYNOMIAL = 0x82F63B78
+
+
+def _crc32c_table() -> list[int]:
+    table = []
+    for i in range(256):
+        crc = i
+        for _ in range(8):
+            crc = (crc >> 1) ^ (CRC32C_POLYNOMIAL if crc & 1 else 0)
+        table.append(crc)
+    return table
+
+
+_CRC32C_TABLE = _crc32c_table()
+
+
+def crc32c(data: bytes) -> int:
+    "CRC-32C (Castagnoli), e.g. `crc32c(b'123456789') == 0xE3069283`."
+    crc = 0xFFFFFFFF
+    for byte in data:
+        crc = (crc >> 8) ^ _CRC32C_TABLE[(crc ^ byte) & 0xFF]
+    return crc ^ 0xFFFFFFFF
+
+
+def crc16(data: bytes) -> int:
+    "CRC-16/CCITT-FALSE, e.g. `crc16(b'123456789') == 0x29B1`."
+    return binascii.crc_hqx(data, 0xFFFF)
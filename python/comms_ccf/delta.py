@@ -0,0 +1,105 @@
+"""
+Delta encoded integer sequences, mirror of `Cbor::Deltas` and
+`Cbor::DeltaView` in comms-ccf/cbor.hpp.
+
+The first value then the difference to each next one, zigzag encoded
+(0, -1, 1, -2, ... as 0, 1, 2, 3, ...) as LEB128 varints in a byte string
+tagged `TAG`. Decoded to a `DeltaSequence`, which is also how to send one.
+
+Like the C++ side, the values and differences wrap at 64 bits, so even a
+jump between the extremes is one 10 byte varint. The bytes don't say
+whether the values are signed, they decode as signed (`int64_t`), and
+`DeltaSequence.unsigned` maps them to `uint64_t` (which the RPC client does
+for returns with the `UNSIGNED_HINT` type hint).
+"""
+
+import typing as t
+from collections import UserList
+
+from cbor2 import CBOREncoder, CBORTag
+
+# First come first served range, but not registered
+TAG = 0xCCF0
+# Schema type hint of unsigned `Cbor::Deltas`, see `Type` in comms-ccf/rpc.hpp
+UNSIGNED_HINT = "list[uint]"
+
+_BITS = 64
+_MASK = (1 << _BITS) - 1
+
+
+class DeltaSequence(UserList):
+    """
+    A list of integers to encode as deltas. Not a `list` subclass, which
+    `cbor2` would encode as a plain array without asking `default`.
+    """
+
+    def unsigned(self) -> "DeltaSequence":
+        "The values as `uint64_t`, for sequences decoded as signed."
+        return DeltaSequence(value & _MASK for value in self)
+
+
+def _zigzag(value: int) -> int:
+    return value << 1 if value >= 0 else (-value << 1) - 1
+
+
+def _unzigzag(value: int) -> int:
+    return value >> 1 if value & 1 == 0 else -((value + 1) >> 1)
+
+
+def _signed(value: int) -> int:
+    "The 64 bit two's complement `value` as `int64_t`."
+    return value - (1 << _BITS) if value >> (_BITS - 1) else value
+
+
+def encode(values: t.Iterable[int]) -> bytes:
+    "The varints of the deltas, without the tag."
+    out = bytearray()
+    prev = 0
+    for value in values:
+        if not -(1 << (_BITS - 1)) <= value <= _MASK:
+            raise ValueError(f"{value} doesn't fit in 64 bits")
+        delta = _zigzag(_signed((value - prev) & _MASK))
+        prev = value
+        while delta >= 0x80:
+            out.append(delta & 0x7F | 0x80)
+            delta >>= 7
+        out.append(delta)
+    return bytes(out)
+
+
+def decode(data: bytes, signed: bool = True) -> DeltaSequence:
+    "Inverse of `encode`, as `int64_t` if `signed` otherwise `uint64_t`."
+    values = DeltaSequence()
+    value = 0
+    delta = 0
+    shift = 0
+    for byte in data:
+        delta |= (byte & 0x7F) << shift
+        shift += 7
+        if byte & 0x80 == 0:
+            if delta > _MASK:
+                raise ValueError("Delta doesn't fit in 64 bits")
+            value = (value + _unzigzag(delta)) & _MASK
+            values.append(_signed(value) if signed else value)
+            delta = 0
+            shift = 0
+        elif shift >= 7 * 10:
+            raise ValueError("Delta doesn't fit in 64 bits")
+    if shift != 0:
+        raise ValueError("Truncated delta sequence")
+    return values
+
+
+def tag_hook(decoder: t.Any, tag: CBORTag) -> t.Any:
+    "For `cbor2.loads(..., tag_hook=tag_hook)`."
+    if tag.tag != TAG or not isinstance(tag.value, bytes):
+        return tag
+    return decode(tag.value)
+
+
+def default(encoder: CBOREncoder, value: t.Any):
+    "For `cbor2.dumps(..., default=default)`."
+    if isinstance(value, DeltaSequence):
+        encoder.encode(CBORTag(TAG, encode(value)))
+    else:
+        raise TypeError(f"Can't encode {type(value).__name__} as CBOR")
@@ -10,6 +10,7 @@ from pathlib import Path
 import cbor2
 from cobs.cobs import DecodeError
 
+from comms_ccf import tags
 from comms_ccf.channel import Channel, Channels
 
 
@@ -46,7 +47,7 @@ async def print_logs(channels: Channels, expect_logs: Path | None = None):
             try:
                 # If there are any more arguments, decode them for formatting
                 while True:
-                    args.append(cbor2.load(argsIo))
+                    args.append(cbor2.load(argsIo, tag_hook=tags.tag_hook))
             except cbor2.CBORDecodeEOF:
                 pass
             try:
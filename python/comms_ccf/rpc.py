@@ -11,10 +11,16 @@ from random import randint
 from textwrap import indent
 
 from cbor2 import dumps, loads
+from fnv_hash_fast import fnv1a_32
 
+from comms_ccf import delta, tags
 from comms_ccf.channel import Channel, Channels
 from comms_ccf.transport import DEFAULT_TIMEOUT
 
+# Function number for calling by the hash of the name, see
+# `Rpc::hashedFunction`
+HASHED_FUNCTION = 0xFF
+
 
 class Rpc:
     def __init__(self, channels: Channels, seqNo: int = randint(0, 0xFF) & ~1):
@@ -24,16 +30,33 @@ class Rpc:
         """
         self._channels = channels
         self._methods: dict[str, t.Callable[..., t.Any]] = {"schema": self.schema}
+        # Return type hints from the schema, by function number and name
+        self._returns: dict[int | str, str] = {}
         self._doc = pydoc.TextDoc()
         self._seqNo = seqNo
 
     async def __call__(
-        self, n: int, args: t.Any, timeout: float = DEFAULT_TIMEOUT
+        self, n: int | str, args: t.Any, timeout: float = DEFAULT_TIMEOUT
     ) -> t.Any:
+        """
+        Calls function number `n`, or if it is a string the function with
+        that name (which doesn't need `discover`).
+        """
+        key = n
+        if isinstance(n, str):
+            name_hash = fnv1a_32(n.encode()).to_bytes(length=4, byteorder="little")
+            n = HASHED_FUNCTION
+        else:
+            name_hash = b""
         async with asyncio.timeout(timeout):
             seqNo = self._seqNo
             self._seqNo = (self._seqNo + 2) & 0xFF
-            data = int.to_bytes(seqNo) + int.to_bytes(n) + dumps(args)
+            data = (
+                int.to_bytes(seqNo)
+                + int.to_bytes(n)
+                + name_hash
+                + dumps(args, default=tags.default)
+            )
             await self._channels.send(Channel.RPC, data, timeout=timeout)
             while True:
                 data = await self._channels.recv(Channel.RPC, timeout=timeout)
@@ -43,10 +66,24 @@ class Rpc:
                 function = data[1]
                 data = data[2:]
                 assert function == n, "Received response to a different function"
-                return loads(data)
+                result = loads(data, tag_hook=tags.tag_hook)
+                if (
+                    isinstance(result, delta.DeltaSequence)
+                    and self._returns.get(key) == delta.UNSIGNED_HINT
+                ):
+                    result = result.unsigned()
+                return result
 
-    async def discover(self, timeout: float = DEFAULT_TIMEOUT):
+    def open(self):
+        "Opens the channel, for calling by name without `discover`."
         self._channels.open_channel(Channel.RPC)
+
+    def by_name(self, name: str) -> t.Callable[..., t.Awaitable[t.Any]]:
+        "Function calling `name` on the device, without needing the schema."
+        return lambda *args, timeout=DEFAULT_TIMEOUT: self(name, args, timeout=timeout)
+
+    async def discover(self, timeout: float = DEFAULT_TIMEOUT):
+        self.open()
         self._schema = await self(0, [], timeout=timeout)
         print("Schema", self._schema)
         assert isinstance(self._schema, list), "Bad schema"
@@ -70,6 +107,7 @@ class Rpc:
             for i in range(0, len(args), 2)
         ]
 
+        self._returns[index] = self._returns[name] = ret
         call = wrapper()
         call.__name__ = name
         call.__doc__ = doc
@@ -0,0 +1,25 @@
+"""
+The CBOR tags the host understands beyond those of `cbor2`, as one
+`tag_hook` and `default` for `cbor2.loads` and `cbor2.dumps`.
+"""
+
+import typing as t
+
+from cbor2 import CBOREncoder, CBORTag
+
+from comms_ccf import delta, typed_array
+
+
+def tag_hook(decoder: t.Any, tag: CBORTag) -> t.Any:
+    "For `cbor2.loads(..., tag_hook=tag_hook)`."
+    if tag.tag == delta.TAG:
+        return delta.tag_hook(decoder, tag)
+    return typed_array.tag_hook(decoder, tag)
+
+
+def default(encoder: CBOREncoder, value: t.Any):
+    "For `cbor2.dumps(..., default=default)`."
+    if isinstance(value, delta.DeltaSequence):
+        delta.default(encoder, value)
+    else:
+        typed_array.default(encoder, value)
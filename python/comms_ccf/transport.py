@@ -5,18 +5,101 @@ checks the checksum.
 
 import asyncio
 import typing as t
+from enum import Enum
 
-from cobs.cobs import DecodeError, decode, encode
+from cobs import cobs, cobsr
+from cobs.cobs import DecodeError
 from fnv_hash_fast import fnv1a_32
 
+from comms_ccf import crc, zpe
 from comms_ccf.hexdump import hexdump
 
 # Float (seconds)
 DEFAULT_TIMEOUT = 0.5
 
-# Channel index (1) + Checksum (4) + b"\0"
-MIN_PKT_SIZE = 6
-MAX_PKT_SIZE = 256
+# Channel index (1) + b"\0", plus the checksum
+MIN_PKT_SIZE = 2
+# Largest packet before framing, see `CcfConfig::maxPktSize`
+MAX_PKT_SIZE = 0xFFFF
+# Worst case framing overhead is a byte every 223 bytes (COBS/ZPE), plus
+# the first header and the b"\0"
+MAX_FRAME_SIZE = MAX_PKT_SIZE + MAX_PKT_SIZE // 223 + 2
+
+
+class Framing(Enum):
+    "Mirror of `Cobs::Variant`, has to match the `CcfConfig::framing`."
+
+    COBS = "cobs"
+    COBSR = "cobsr"
+    ZPE = "zpe"
+
+    def __str__(self) -> str:
+        return self.value
+
+    def encode(self, data: bytes) -> bytes:
+        "Encodes a frame, without the zero delimiter."
+        match self:
+            case Framing.COBS:
+                return cobs.encode(data)
+            case Framing.COBSR:
+                return cobsr.encode(data)
+            case Framing.ZPE:
+                return zpe.encode(data)
+
+    def decode(self, data: bytes) -> bytes:
+        "Decodes a frame, without the zero delimiter."
+        match self:
+            case Framing.COBS:
+                return cobs.decode(data)
+            case Framing.COBSR:
+                try:
+                    return cobsr.decode(data)
+                except cobsr.DecodeError as e:
+                    raise DecodeError(str(e)) from e
+            case Framing.ZPE:
+                return zpe.decode(data)
+
+
+class Checksum(Enum):
+    """
+    Mirror of `Checksum::Kind`, has to match the `CcfConfig::checksum`.
+    Both `Crc32c` and `Crc32cHw` are `CRC32C` on the wire.
+    """
+
+    FNV1A = "fnv1a"
+    CRC32C = "crc32c"
+    CRC16 = "crc16"
+    NONE = "none"
+
+    def __str__(self) -> str:
+        return self.value
+
+    @property
+    def size(self) -> int:
+        "Bytes on the wire."
+        match self:
+            case Checksum.FNV1A | Checksum.CRC32C:
+                return 4
+            case Checksum.CRC16:
+                return 2
+            case Checksum.NONE:
+                return 0
+
+    def compute(self, data: bytes) -> int:
+        match self:
+            case Checksum.FNV1A:
+                return fnv1a_32(data)
+            case Checksum.CRC32C:
+                return crc.crc32c(data)
+            case Checksum.CRC16:
+                return crc.crc16(data)
+            case Checksum.NONE:
+                return 0
+
+    def append(self, data: bytes) -> bytes:
+        "Appends the checksum of `data`, as it goes on the wire."
+        checksum = self.compute(data).to_bytes(length=self.size, byteorder="little")
+        return data + checksum
 
 
 class Transport(t.Protocol):
@@ -37,19 +120,23 @@ class StreamTransport:
         rx: asyncio.StreamReader,
         tx: asyncio.StreamWriter,
         log_fp: t.Optional[t.TextIO] = None,
+        framing: Framing = Framing.COBS,
+        checksum: Checksum = Checksum.FNV1A,
     ) -> None:
         self._tx = tx
         self._rx = rx
         self._rxBuf = b""
         self._done = False
         self._log = log_fp
+        self._framing = framing
+        self._checksum = checksum
 
     async def send(
         self, channel: int, data: bytes, *, timeout: float = DEFAULT_TIMEOUT
     ):
         data = int.to_bytes(channel) + data
-        data = data + fnv1a_32(data).to_bytes(length=4, byteorder="little")
-        data = encode(data) + b"\0"
+        data = self._checksum.append(data)
+        data = self._framing.encode(data) + b"\0"
         if self._log:
             print(hexdump(data, "TX: "), file=self._log)
         async with asyncio.timeout(timeout):
@@ -75,23 +162,26 @@ class StreamTransport:
                         data = b""
                         self._done = True
                     self._rxBuf += rxed
-                    if len(self._rxBuf) >= MAX_PKT_SIZE:
+                    if len(self._rxBuf) > MAX_FRAME_SIZE:
                         self._rxBuf = b""
                         raise AssertionError("Packet max size exceeded")
         if self._log:
             print(hexdump(data, "RX: "), file=self._log)
-        assert len(data) >= MIN_PKT_SIZE, "Packet too small\n" + hexdump(data, "pkt> ")
+        assert len(data) >= MIN_PKT_SIZE + self._checksum.size, (
+            "Packet too small\n" + hexdump(data, "pkt> ")
+        )
         try:
-            decoded = decode(data[:-1])
+            decoded = self._framing.decode(data[:-1])
         except DecodeError as e:
             print(str(e) + "\n" + hexdump(data, "pkt> "))
             raise
-        checksum = int.from_bytes(decoded[-4:], byteorder="little")
-        expected = fnv1a_32(decoded[:-4])
+        end = len(decoded) - self._checksum.size
+        checksum = int.from_bytes(decoded[end:], byteorder="little")
+        expected = self._checksum.compute(decoded[:end])
         assert (
             expected == checksum
         ), f"Bad checksum {checksum:08X} expected {expected:08X}\n" + hexdump(
             decoded, "pkt> "
         )
         channel = decoded[0]
-        return (channel, decoded[1:-4])
+        return (channel, decoded[1:end])
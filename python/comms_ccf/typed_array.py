@@ -0,0 +1,85 @@
+"""
+RFC 8746 typed arrays (CBOR tags 64 to 87), mirror of `Cbor::TypedArray`
+in comms-ccf/cbor.hpp.
+
+Decoded to `array.array` (or a list of floats for half floats, which
+`array` doesn't have), and `array.array` is encoded as a typed array, so
+e.g. blocks of ADC samples don't go one number at a time.
+"""
+
+import array
+import struct
+import sys
+import typing as t
+
+from cbor2 import CBOREncoder, CBORTag
+
+FIRST_TAG = 64
+LAST_TAG = 87
+# Bytes clamped to 0-255, the same on the wire as tag 64
+CLAMPED_TAG = 68
+
+_NATIVE_LITTLE = sys.byteorder == "little"
+
+
+def _typecode(floating: bool, signed: bool, size: int) -> str | None:
+    "The `array` typecode (`struct` format for half floats) of the element type."
+    if floating:
+        candidates = "efd"
+    elif signed:
+        candidates = "bhilq"
+    else:
+        candidates = "BHILQ"
+    for code in candidates:
+        if code == "e":
+            if size == 2:
+                return code
+        elif array.array(code).itemsize == size:
+            return code
+    return None
+
+
+def _layout(tag: int) -> tuple[str, bool] | None:
+    "Typecode and whether little endian, for a typed array tag."
+    if tag == CLAMPED_TAG:
+        return "B", True
+    floating = bool(tag & 0x10)
+    signed = bool(tag & 0x08)
+    little = bool(tag & 0x04)
+    size = 1 << ((tag & 0x03) + (1 if floating else 0))
+    if size == 1 and little:
+        return None  # Reserved
+    code = _typecode(floating, signed, size)  # None for 128 bit floats
+    return (code, little or size == 1) if code is not None else None
+
+
+def _tag(code: str) -> int:
+    size = array.array(code).itemsize
+    floating = code in "fd"
+    signed = code in "bhilq"
+    log2_size = size.bit_length() - 1 - (1 if floating else 0)
+    little = _NATIVE_LITTLE and size > 1
+    return FIRST_TAG | floating << 4 | signed << 3 | little << 2 | log2_size
+
+
+def tag_hook(decoder: t.Any, tag: CBORTag) -> t.Any:
+    "For `cbor2.loads(..., tag_hook=tag_hook)`."
+    layout = _layout(tag.tag) if FIRST_TAG <= tag.tag <= LAST_TAG else None
+    if layout is None or not isinstance(tag.value, bytes):
+        return tag
+    code, little = layout
+    if code == "e":
+        order = "<" if little else ">"
+        return [value for (value,) in struct.iter_unpack(order + "e", tag.value)]
+    values = array.array(code, tag.value)
+    if little != _NATIVE_LITTLE:
+        values.byteswap()
+    return values
+
+
+def default(encoder: CBOREncoder, value: t.Any):
+    "For `cbor2.dumps(..., default=default)`."
+    if isinstance(value, array.array) and value.typecode in "fdbhilqBHILQ":
+        encoder.encode(CBORTag(_tag(value.typecode), value.tobytes()))
+    else:
+        raise TypeError(f"Can't encode {type(value).__name__} as CBOR")
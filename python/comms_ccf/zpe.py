@@ -0,0 +1,75 @@
+"""
+COBS/ZPE (zero pair elimination), a mirror of the `Cobs::Variant::Zpe`
+framing in comms-ccf/cobs.hpp. Headers up to 0xDF are the same as COBS, 0xE0
+is a run of 223 bytes without a zero after, and from 0xE1 the run (of up to
+30 bytes) is followed by two zeros.
+"""
+
+from cobs.cobs import DecodeError
+
+PAIR_HEADER = 0xE1
+MAX_RUN = PAIR_HEADER - 2
+MAX_PAIR_RUN = 0xFF - PAIR_HEADER
+
+
+def encode(data: bytes) -> bytes:
+    "Encodes `data`, not including the zero delimiter."
+    out = bytearray()
+    start = 0
+    while True:
+        end = data.find(0, start, start + MAX_RUN)
+        if end == -1:
+            end = min(len(data), start + MAX_RUN)
+        run = end - start
+        if run == MAX_RUN:
+            # No implicit zero, the next header continues the run
+            out.append(run + 1)
+            out += data[start:end]
+            start = end
+            if start == len(data):
+                break
+        elif end == len(data):
+            # Ends with the implicit zero
+            out.append(run + 1)
+            out += data[start:end]
+            break
+        elif run <= MAX_PAIR_RUN and (end + 1 == len(data) or data[end + 1] == 0):
+            # The second zero might be the implicit one at the end
+            out.append(PAIR_HEADER + run)
+            out += data[start:end]
+            if end + 1 == len(data):
+                break
+            start = end + 2
+        else:
+            out.append(run + 1)
+            out += data[start:end]
+            start = end + 1
+    return bytes(out)
+
+
+def decode(data: bytes) -> bytes:
+    "Decodes `data`, which should not include the zero delimiter."
+    out = bytearray()
+    idx = 0
+    zeros = 0
+    while idx < len(data):
+        header = data[idx]
+        idx += 1
+        if header == 0:
+            raise DecodeError("zero byte found in input")
+        out += bytes(zeros)
+        if header >= PAIR_HEADER:
+            run = header - PAIR_HEADER
+            zeros = 2
+        else:
+            run = header - 1
+            zeros = 0 if run == MAX_RUN else 1
+        if idx + run > len(data):
+            raise DecodeError("not enough input bytes for length code")
+        if 0 in data[idx : idx + run]:
+            raise DecodeError("zero byte found in input")
+        out += data[idx : idx + run]
+        idx += run
+    # The last implicit zero is not data
+    out += bytes(max(zeros - 1, 0))
+    return bytes(out)
@@ -0,0 +1,199 @@
+/*
+
+# Simple benchmark utils
+
+Just enough for timing small loops and printing the results as JSON, one
+object per benchmark executable:
+
+    {
+      "suite": "cobs",
+      "build_type": "Release",
+      "results": [
+        {"name": "encode", "size": 1024, "zero_density": 0.1,
+         "ns_per_op": 812.5, "mb_per_s": 1260.3, "bytes_per_cycle": 0.4},
+        ...
+      ]
+    }
+
+Build with optimisations (e.g. `-DCMAKE_BUILD_TYPE=Release`), the default
+Debug build is only good for checking the benchmarks run. Pass `--quick`
+to run each benchmark only once (for the tests).
+
+The `bytes_per_cycle` is only there on x86, and uses the time-stamp
+counter, so it counts reference cycles (at the base clock) rather than
+core cycles, which differ with turbo or power saving.
+
+*/
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <initializer_list>
+#include <random>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_CYCLES 1
+#endif
+
+#if !defined(BENCH_BUILD_TYPE)
+#define BENCH_BUILD_TYPE "unknown"
+#endif
+
+namespace Bench
+{
+    /// Stops the compiler from optimising away the computation of `value`.
+    template<typename T>
+    inline void keep(const T & value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    /// Stops the compiler from assuming it knows what is in `value`.
+    template<typename T>
+    inline void clobber(T & value)
+    {
+        asm volatile("" : "+r,m"(value) : : "memory");
+    }
+
+    /// Random bytes where each is zero with the probability `zeroDensity`.
+    inline std::vector<uint8_t> bytes(size_t size, double zeroDensity, uint32_t seed = 1)
+    {
+        std::mt19937 rng{seed};
+        std::bernoulli_distribution zero{zeroDensity};
+        std::uniform_int_distribution<int> nonZero{1, 255};
+        std::vector<uint8_t> data(size);
+        for (auto & byte : data)
+        {
+            byte = zero(rng) ? 0 : static_cast<uint8_t>(nonZero(rng));
+        }
+        return data;
+    }
+
+    using Param = std::pair<const char *, double>;
+
+    /// Times benchmarks and prints them as JSON on destruction.
+    class Suite
+    {
+    public:
+        Suite(const char * _name, int argc, char ** argv) : name(_name)
+        {
+            for (int i = 1; i < argc; ++i)
+            {
+                quick = quick || strcmp(argv[i], "--quick") == 0;
+            }
+        }
+
+        ~Suite()
+        {
+            printf("{\n  \"suite\": \"%s\",\n", name);
+            printf("  \"build_type\": \"%s\",\n", BENCH_BUILD_TYPE);
+            printf("  \"quick\": %s,\n", quick ? "true" : "false");
+            printf("  \"results\": [%s", results.empty() ? "" : "\n");
+            for (size_t i = 0; i < results.size(); ++i)
+            {
+                printf("    %s%s\n", results[i].c_str(), i + 1 < results.size() ? "," : "");
+            }
+            printf("  ]\n}\n");
+        }
+
+        /// Runs `fn` (one operation over `bytes` bytes) for long enough
+        /// to be measurable, taking the best of a few repeats, and records
+        /// the time per operation.
+        template<typename Fn>
+        void run(const char * benchmark, size_t bytes, std::initializer_list<Param> params, Fn && fn)
+        {
+            using Clock = std::chrono::steady_clock;
+            constexpr auto minTime = std::chrono::milliseconds(20);
+            size_t iterations = 1;
+            double best = 0;
+            double bestCycles = 0;
+            for (int repeat = 0; repeat < (quick ? 1 : 5); ++repeat)
+            {
+                while (true)
+                {
+                    const auto start = Clock::now();
+                    const uint64_t startCycles = cycles();
+                    for (size_t i = 0; i < iterations; ++i)
+                    {
+                        fn();
+                    }
+                    const double elapsedCycles = static_cast<double>(cycles() - startCycles);
+                    const std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+                    if (quick || elapsed >= minTime)
+                    {
+                        const double ns = elapsed.count() / iterations;
+                        best = repeat == 0 ? ns : std::min(best, ns);
+                        const double perOp = elapsedCycles / iterations;
+                        bestCycles = repeat == 0 ? perOp : std::min(bestCycles, perOp);
+                        break;
+                    }
+                    iterations *= 2;
+                }
+            }
+            char buf[512];
+            int len = format(buf, sizeof(buf), benchmark, bytes, params);
+            // Bytes per ns is GB/s, times a thousand for MB/s
+            len += snprintf(
+                buf + len, sizeof(buf) - len,
+                ", \"ns_per_op\": %.2f, \"mb_per_s\": %.1f",
+                best, bytes == 0 ? 0.0 : 1000.0 * bytes / best);
+#if defined(BENCH_CYCLES)
+            len += snprintf(
+                buf + len, sizeof(buf) - len,
+                ", \"bytes_per_cycle\": %.3f",
+                bestCycles == 0 ? 0.0 : bytes / bestCycles);
+#endif
+            snprintf(buf + len, sizeof(buf) - len, "}");
+            results.emplace_back(buf);
+        }
+
+        /// Records a result that isn't a time, e.g. an error count.
+        void report(const char * benchmark, size_t bytes, std::initializer_list<Param> params)
+        {
+            char buf[512];
+            const int len = format(buf, sizeof(buf), benchmark, bytes, params);
+            snprintf(buf + len, sizeof(buf) - len, "}");
+            results.emplace_back(buf);
+        }
+
+        /// Whether `--quick` was given, e.g. to use fewer trials.
+        bool isQuick() const { return quick; }
+
+    private:
+        static uint64_t cycles()
+        {
+#if defined(BENCH_CYCLES)
+            return __rdtsc();
+#else
+            return 0;
+#endif
+        }
+
+        /// Formats the start of a result, without the closing brace.
+        static int format(
+            char * buf, size_t size,
+            const char * benchmark, size_t bytes, std::initializer_list<Param> params)
+        {
+            int len = snprintf(buf, size, "{\"name\": \"%s\", \"size\": %zu", benchmark, bytes);
+            for (const auto & [key, value] : params)
+            {
+                len += snprintf(buf + len, size - len, ", \"%s\": %.10g", key, value);
+            }
+            return len;
+        }
+
+        const char * name;
+        bool quick = false;
+        std::vector<std::string> results;
+    };
+}
@@ -0,0 +1,111 @@
+/**
+\file
+
+Encode and decode times of the CBOR types used by RPC calls, see
+test/bench.hpp.
+
+*/
+#include "cbor.hpp"
+
+#include "bench.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <span>
+#include <string_view>
+#include <tuple>
+
+static std::array<uint8_t, 1024> buffer;
+
+template<typename T>
+static void benchEncode(Bench::Suite & suite, const char * name, T value)
+{
+    std::span<uint8_t> out{buffer};
+    Cbor::Cbor<T>::encode(value, out);
+    const size_t size = buffer.size() - out.size();
+    suite.run(name, size, {}, [&]()
+    {
+        std::span<uint8_t> buf{buffer};
+        Bench::clobber(value);
+        Bench::keep(Cbor::Cbor<T>::encode(value, buf));
+        Bench::keep(buffer);
+    });
+}
+
+template<typename T>
+static void benchDecode(Bench::Suite & suite, const char * name, T value)
+{
+    std::span<uint8_t> out{buffer};
+    Cbor::Cbor<T>::encode(value, out);
+    const size_t size = buffer.size() - out.size();
+    suite.run(name, size, {}, [&]()
+    {
+        std::span<uint8_t> buf{buffer.data(), size};
+        Bench::clobber(buffer);
+        const auto decoded = Cbor::Cbor<T>::decode(buf);
+        Bench::keep(decoded);
+    });
+}
+
+template<typename T>
+static void benchBoth(Bench::Suite & suite, const char * encodeName, const char * decodeName, T value)
+{
+    benchEncode(suite, encodeName, value);
+    benchDecode(suite, decodeName, value);
+}
+
+int main(int argc, char ** argv)
+{
+    Bench::Suite suite("cbor", argc, argv);
+    benchBoth<uint32_t>(suite, "encode_u32_small", "decode_u32_small", 10);
+    benchBoth<uint32_t>(suite, "encode_u32_large", "decode_u32_large", 0x12345678);
+    benchBoth<int32_t>(suite, "encode_i32", "decode_i32", -100000);
+    benchBoth<int64_t>(suite, "encode_i64", "decode_i64", -0x123456789ab);
+    benchBoth<float>(suite, "encode_float", "decode_float", 1.5f);
+    benchBoth<double>(suite, "encode_double", "decode_double", 3.14159);
+    benchBoth<Cbor::AsHalf<float>>(suite, "encode_float_as_half", "decode_float_as_half", {1.1f});
+    benchBoth<bool>(suite, "encode_bool", "decode_bool", true);
+    benchBoth<std::tuple<int, int>>(suite, "encode_tuple_int_int", "decode_tuple_int_int", {1000, -2000});
+    benchBoth<std::array<uint32_t, 16>>(
+        suite, "encode_array_u32x16", "decode_array_u32x16",
+        {0, 1, 23, 24, 255, 256, 65535, 65536, 0x12345678, 7, 8, 9, 10, 11, 12, 13});
+    // A block of ADC samples, one number at a time or as a typed array
+    static std::array<uint16_t, 256> samples{};
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+        samples[i] = static_cast<uint16_t>(i * 997 % 4096);
+    }
+    benchBoth(suite, "encode_array_u16x256", "decode_array_u16x256", samples);
+    using Samples = Cbor::TypedArray<uint16_t, 256>;
+    benchBoth(suite, "encode_typed_array_u16x256", "decode_typed_array_u16x256", Samples{samples});
+    // Timestamps about a millisecond apart, whole or as deltas
+    static std::array<uint32_t, 128> timestamps{};
+    for (size_t i = 0; i < timestamps.size(); ++i)
+    {
+        timestamps[i] = static_cast<uint32_t>(1000000 + 1000 * i + i * 7 % 5);
+    }
+    benchBoth(suite, "encode_array_u32x128", "decode_array_u32x128", timestamps);
+    benchEncode(suite, "encode_deltas_u32x128", Cbor::Deltas<uint32_t>{timestamps});
+    {
+        std::span<uint8_t> out{buffer};
+        Cbor::Cbor<Cbor::Deltas<uint32_t>>::encode({timestamps}, out);
+        const size_t size = buffer.size() - out.size();
+        suite.run("decode_deltas_u32x128", size, {}, [&]()
+        {
+            std::span<uint8_t> buf{buffer.data(), size};
+            Bench::clobber(buffer);
+            const auto decoded = Cbor::Cbor<Cbor::DeltaView<uint32_t>>::decode(buf);
+            uint32_t last = 0;
+            for (uint32_t timestamp : *decoded)
+            {
+                last = timestamp;
+            }
+            Bench::keep(last);
+        });
+    }
+    benchEncode<std::string_view>(suite, "encode_string_view", "Hello, world! This is a log message");
+    static std::array<uint8_t, 64> bytes{};
+    benchEncode<std::span<uint8_t>>(suite, "encode_bytes", std::span{bytes});
+}
@@ -0,0 +1,357 @@
+/**
+\file
+
+Compares the frame checksums, and a couple of other candidates, on both
+speed and how many errors get past them, see test/bench.hpp.
+
+Throughput is over the whole span (`bulk`) and, for the ones in
+[checksums](#checksum.hpp), also a byte at a time (`feed`) as the RX
+path does it.
+
+The error rates are the fraction of corrupted frames that still pass
+the checksum, for UART-like faults on a 64 byte frame:
+
+- `bit_flip`, `two_bit_flips`: noise flipping bits;
+- `dropped_byte`: an overrun losing a byte;
+- `burst`: noise at connect/disconnect overwriting up to 32 bytes with
+  0x00 (breaks), 0xFF (idle line) or random bytes;
+- `cobs_bit_flip`, `cobs_dropped_byte`: the same faults but on the COBS
+  encoded frame, so they also hit the framing. Each frame the decoder
+  then produces counts, if it passes but isn't the one sent.
+
+A 32-bit checksum should let about one in 2^32 through, so with a million
+trials any failures there are a bad sign. The 16-bit ones should be about
+one in 65536.
+
+*/
+#include "checksum.hpp"
+#include "cobs.hpp"
+
+#include "bench.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <span>
+#include <vector>
+
+namespace
+{
+    constexpr uint32_t load32(const uint8_t * p)
+    {
+        return
+            (static_cast<uint32_t>(p[0]) <<  0) |
+            (static_cast<uint32_t>(p[1]) <<  8) |
+            (static_cast<uint32_t>(p[2]) << 16) |
+            (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    constexpr uint32_t rotl(uint32_t x, int r)
+    {
+        return (x << r) | (x >> (32 - r));
+    }
+
+    /// One of the checksums in checksum.hpp.
+    template<Checksum::Kind K>
+    struct Library
+    {
+        using P = Checksum::Policy<K>;
+        static constexpr size_t size = P::size;
+        static constexpr bool hasFeed = true;
+
+        static uint32_t compute(std::span<const uint8_t> span)
+        {
+            return P::value(P::update(P::initial, span));
+        }
+
+        static uint32_t feed(std::span<const uint8_t> span)
+        {
+            auto state = P::initial;
+            for (const auto byte : span)
+            {
+                state = P::feed(state, byte);
+            }
+            return P::value(state);
+        }
+    };
+
+    /// Fletcher-32 over little endian 16-bit words, padding odd lengths
+    /// with a zero.
+    struct Fletcher32
+    {
+        static constexpr size_t size = 4;
+        static constexpr bool hasFeed = false;
+
+        static constexpr uint32_t compute(std::span<const uint8_t> span)
+        {
+            uint32_t sum1 = 0xFFFF;
+            uint32_t sum2 = 0xFFFF;
+            size_t words = (span.size() + 1) / 2;
+            size_t i = 0;
+            while (words > 0)
+            {
+                // Largest block that can't overflow before reducing
+                size_t block = std::min<size_t>(words, 359);
+                words -= block;
+                for (; block > 0; --block, i += 2)
+                {
+                    const uint32_t hi = i + 1 < span.size() ? span[i + 1] : 0;
+                    sum1 += span[i] | (hi << 8);
+                    sum2 += sum1;
+                }
+                sum1 = (sum1 & 0xFFFF) + (sum1 >> 16);
+                sum2 = (sum2 & 0xFFFF) + (sum2 >> 16);
+            }
+            sum1 = (sum1 & 0xFFFF) + (sum1 >> 16);
+            sum2 = (sum2 & 0xFFFF) + (sum2 >> 16);
+            return (sum2 << 16) | sum1;
+        }
+    };
+
+    /// xxHash32 with a zero seed.
+    struct XxHash32
+    {
+        static constexpr size_t size = 4;
+        static constexpr bool hasFeed = false;
+
+        static constexpr uint32_t prime1 = 0x9E3779B1;
+        static constexpr uint32_t prime2 = 0x85EBCA77;
+        static constexpr uint32_t prime3 = 0xC2B2AE3D;
+        static constexpr uint32_t prime4 = 0x27D4EB2F;
+        static constexpr uint32_t prime5 = 0x165667B1;
+
+        static constexpr uint32_t round(uint32_t acc, uint32_t input)
+        {
+            return rotl(acc + input * prime2, 13) * prime1;
+        }
+
+        static constexpr uint32_t compute(std::span<const uint8_t> span)
+        {
+            const uint8_t * p = span.data();
+            size_t len = span.size();
+            uint32_t hash;
+            if (len >= 16)
+            {
+                uint32_t v1 = prime1 + prime2;
+                uint32_t v2 = prime2;
+                uint32_t v3 = 0;
+                uint32_t v4 = 0 - prime1;
+                for (; len >= 16; len -= 16, p += 16)
+                {
+                    v1 = round(v1, load32(p));
+                    v2 = round(v2, load32(p + 4));
+                    v3 = round(v3, load32(p + 8));
+                    v4 = round(v4, load32(p + 12));
+                }
+                hash = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+            }
+            else
+            {
+                hash = prime5;
+            }
+            hash += static_cast<uint32_t>(span.size());
+            for (; len >= 4; len -= 4, p += 4)
+            {
+                hash = rotl(hash + load32(p) * prime3, 17) * prime4;
+            }
+            for (; len > 0; --len, ++p)
+            {
+                hash = rotl(hash + *p * prime5, 11) * prime1;
+            }
+            hash ^= hash >> 15;
+            hash *= prime2;
+            hash ^= hash >> 13;
+            hash *= prime3;
+            hash ^= hash >> 16;
+            return hash;
+        }
+    };
+
+    constexpr std::array<uint8_t, 6> abcdef{'a', 'b', 'c', 'd', 'e', 'f'};
+    static_assert(Fletcher32::compute(std::span{abcdef}.first(5)) == 0xF04FC729);
+    static_assert(Fletcher32::compute(std::span{abcdef}) == 0x56502D2A);
+    static_assert(XxHash32::compute({}) == 0x02CC5D05);
+    static_assert(XxHash32::compute(std::span{abcdef}.first(3)) == 0x32D153FF);
+
+    /// Whether the last `C::size` bytes of the frame are its checksum.
+    template<typename C>
+    bool accepts(std::span<const uint8_t> frame)
+    {
+        if (frame.size() < C::size)
+        {
+            return false;
+        }
+        const uint32_t value = C::compute(frame.first(frame.size() - C::size));
+        for (size_t i = 0; i < C::size; ++i)
+        {
+            if (frame[frame.size() - C::size + i] != static_cast<uint8_t>(value >> (8 * i)))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template<typename C>
+    std::vector<uint8_t> makeFrame(std::mt19937 & rng, size_t size)
+    {
+        // Mostly small CBOR-like values, so some zeros for COBS to remove
+        std::bernoulli_distribution zero{0.1};
+        std::uniform_int_distribution<int> nonZero{1, 255};
+        std::vector<uint8_t> frame(size - C::size);
+        for (auto & byte : frame)
+        {
+            byte = zero(rng) ? 0 : static_cast<uint8_t>(nonZero(rng));
+        }
+        const uint32_t value = C::compute(frame);
+        for (size_t i = 0; i < C::size; ++i)
+        {
+            frame.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+        return frame;
+    }
+
+    void flipBit(std::mt19937 & rng, std::vector<uint8_t> & data)
+    {
+        const size_t bit = std::uniform_int_distribution<size_t>{0, data.size() * 8 - 1}(rng);
+        data[bit / 8] ^= static_cast<uint8_t>(1 << (bit % 8));
+    }
+
+    void dropByte(std::mt19937 & rng, std::vector<uint8_t> & data)
+    {
+        const size_t index = std::uniform_int_distribution<size_t>{0, data.size() - 1}(rng);
+        data.erase(data.begin() + index);
+    }
+
+    void burst(std::mt19937 & rng, std::vector<uint8_t> & data)
+    {
+        const size_t length = std::uniform_int_distribution<size_t>{1, std::min<size_t>(32, data.size())}(rng);
+        const size_t start = std::uniform_int_distribution<size_t>{0, data.size() - length}(rng);
+        std::uniform_int_distribution<int> kind{0, 2};
+        std::uniform_int_distribution<int> random{0, 255};
+        for (size_t i = start; i < start + length; ++i)
+        {
+            switch (kind(rng))
+            {
+            case 0: data[i] = 0x00; break;
+            case 1: data[i] = 0xFF; break;
+            default: data[i] = static_cast<uint8_t>(random(rng)); break;
+            }
+        }
+    }
+
+    /// Number of corrupted frames (by `fault`) accepted by the checksum,
+    /// out of `trials`.
+    template<typename C, typename Fault>
+    size_t undetected(size_t trials, size_t frameSize, Fault && fault)
+    {
+        std::mt19937 rng{1};
+        size_t count = 0;
+        for (size_t trial = 0; trial < trials; ++trial)
+        {
+            const auto frame = makeFrame<C>(rng, frameSize);
+            auto corrupted = frame;
+            fault(rng, corrupted);
+            count += corrupted != frame && accepts<C>(corrupted);
+        }
+        return count;
+    }
+
+    /// Same as `undetected`, but the fault is on the COBS encoded stream
+    /// and every frame decoded from it is checked.
+    template<typename C, typename Fault>
+    size_t undetectedCobs(size_t trials, size_t frameSize, Fault && fault)
+    {
+        std::mt19937 rng{1};
+        size_t count = 0;
+        std::vector<uint8_t> encoded;
+        std::vector<uint8_t> decoded;
+        for (size_t trial = 0; trial < trials; ++trial)
+        {
+            const auto frame = makeFrame<C>(rng, frameSize);
+            encoded.assign(Cobs::maxEncodedSize(frame.size()) + 2, 0);
+            // Delimiters on both sides, as if in the middle of a stream
+            const size_t size = *Cobs::encode(frame, std::span{encoded}.subspan(1));
+            encoded.resize(size + 2);
+            fault(rng, encoded);
+
+            Cobs::Decoder<> decoder;
+            decoded.clear();
+            for (const auto byte : encoded)
+            {
+                const bool end = decoder.feed(byte, [&](uint8_t value) { decoded.push_back(value); });
+                if (end)
+                {
+                    count += !decoder.truncated() && decoded != frame && accepts<C>(decoded);
+                    decoded.clear();
+                }
+            }
+        }
+        return count;
+    }
+
+    template<typename C>
+    void benchChecksum(Bench::Suite & suite, const char * name)
+    {
+        char benchmark[64];
+        for (const size_t size : {16, 256, 4096})
+        {
+            auto data = Bench::bytes(size, 0.0);
+            snprintf(benchmark, sizeof(benchmark), "%s_bulk", name);
+            suite.run(benchmark, size, {}, [&]()
+            {
+                Bench::clobber(data);
+                Bench::keep(C::compute(data));
+            });
+            if constexpr (C::hasFeed)
+            {
+                snprintf(benchmark, sizeof(benchmark), "%s_feed", name);
+                suite.run(benchmark, size, {}, [&]()
+                {
+                    Bench::clobber(data);
+                    Bench::keep(C::feed(data));
+                });
+            }
+        }
+
+        const size_t trials = suite.isQuick() ? 1000 : 1000000;
+        constexpr size_t frameSize = 64;
+        const auto report = [&](const char * model, size_t count)
+        {
+            snprintf(benchmark, sizeof(benchmark), "%s_%s", name, model);
+            suite.report(benchmark, frameSize, {
+                {"trailer_bytes", static_cast<double>(C::size)},
+                {"trials", static_cast<double>(trials)},
+                {"undetected", static_cast<double>(count)},
+                {"undetected_rate", static_cast<double>(count) / trials},
+            });
+        };
+        report("bit_flip", undetected<C>(trials, frameSize, flipBit));
+        report("two_bit_flips", undetected<C>(trials, frameSize, [](auto & rng, auto & data)
+        {
+            flipBit(rng, data);
+            flipBit(rng, data);
+        }));
+        report("dropped_byte", undetected<C>(trials, frameSize, dropByte));
+        report("burst", undetected<C>(trials, frameSize, burst));
+        report("cobs_bit_flip", undetectedCobs<C>(trials, frameSize, flipBit));
+        report("cobs_dropped_byte", undetectedCobs<C>(trials, frameSize, dropByte));
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    using enum Checksum::Kind;
+    Bench::Suite suite("checksum", argc, argv);
+    benchChecksum<Library<Fnv1a>>(suite, "fnv1a");
+    benchChecksum<Library<Crc32c>>(suite, "crc32c");
+#if defined(__SSE4_2__) || defined(__ARM_FEATURE_CRC32)
+    benchChecksum<Library<Crc32cHw>>(suite, "crc32c_hw");
+#endif
+    benchChecksum<Library<Crc16>>(suite, "crc16");
+    benchChecksum<Fletcher32>(suite, "fletcher32");
+    benchChecksum<XxHash32>(suite, "xxhash32");
+}
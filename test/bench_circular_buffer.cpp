@@ -0,0 +1,70 @@
+/**
+\file
+
+Throughput of the circular buffer, both the per-element path used for
+receiving and the reserve/commit path used for sending, see
+test/bench.hpp.
+
+*/
+#include "circular_buffer.hpp"
+
+#include "bench.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <optional>
+
+constexpr size_t MAX_PKT_SIZE = 256;
+constexpr size_t BUF_SIZE = 1024;
+using Buffer = CircularBuffer<uint8_t, BUF_SIZE, MAX_PKT_SIZE>;
+static Buffer buf;
+
+int main(int argc, char ** argv)
+{
+    Bench::Suite suite("circular_buffer", argc, argv);
+    const auto data = Bench::bytes(MAX_PKT_SIZE, 0.0);
+
+    for (const size_t size : {16, 64, 256})
+    {
+        suite.run("push_back_notify", size, {}, [&]()
+        {
+            buf.reset();
+            for (size_t i = 0; i < size; ++i)
+            {
+                buf.push_back(data[i]);
+            }
+            buf.notify();
+            Bench::keep(buf);
+        });
+
+        suite.run("reserve_commit_notify", size, {}, [&]()
+        {
+            buf.reset();
+            buf.reserve(size);
+            for (size_t i = 0; i < size; ++i)
+            {
+                buf.reserved(i) = data[i];
+            }
+            buf.commit(size);
+            buf.notify();
+            Bench::keep(buf);
+        });
+
+        suite.run("get_frame_iterate", size, {}, [&]()
+        {
+            buf.reset();
+            buf.reserve(size);
+            buf.commit(size);
+            buf.notify();
+            std::optional<Buffer::Frame> frame;
+            buf.get_frame(frame);
+            uint8_t sum = 0;
+            for (const auto byte : *frame)
+            {
+                sum += byte;
+            }
+            Bench::keep(sum);
+        });
+    }
+}
@@ -0,0 +1,87 @@
+/**
+\file
+
+Throughput of the COBS encoders and decoders over different zero
+densities, see test/bench.hpp.
+
+*/
+#include "cobs.hpp"
+
+#include "bench.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <span>
+#include <vector>
+
+template<Cobs::Variant V>
+static void benchVariant(Bench::Suite & suite, const char * prefix, std::span<const uint8_t> data, double density)
+{
+    char name[64];
+    std::vector<uint8_t> encoded(Cobs::maxEncodedSize(data.size(), V) + 1);
+    std::vector<uint8_t> decoded(data.size());
+    const size_t encodedSize = *Cobs::encode<V>(data, std::span{encoded});
+    encoded[encodedSize] = 0;
+    const std::span<const uint8_t> frame{encoded.data(), encodedSize + 1};
+
+    snprintf(name, sizeof(name), "%sencode", prefix);
+    suite.run(name, data.size(), {{"zero_density", density}}, [&]()
+    {
+        Bench::keep(Cobs::encode<V>(data, std::span{encoded}));
+        Bench::clobber(encoded);
+    });
+
+    snprintf(name, sizeof(name), "%sencoder_iterator", prefix);
+    suite.run(name, data.size(), {{"zero_density", density}}, [&]()
+    {
+        size_t i = 0;
+        for (const auto byte : Cobs::Encoder<V>(data))
+        {
+            encoded[i++] = byte;
+        }
+        Bench::clobber(encoded);
+    });
+
+    snprintf(name, sizeof(name), "%swriter", prefix);
+    suite.run(name, data.size(), {{"zero_density", density}}, [&]()
+    {
+        const auto out = [&](size_t index) -> uint8_t & { return encoded[index]; };
+        Cobs::Writer<V, decltype(out)> writer{out};
+        writer.push(data);
+        Bench::keep(writer.finish());
+        Bench::clobber(encoded);
+    });
+
+    snprintf(name, sizeof(name), "%sdecode", prefix);
+    suite.run(name, data.size(), {{"zero_density", density}}, [&]()
+    {
+        Cobs::Decoder<V> decoder;
+        Bench::keep(decoder.decode(frame, std::span{decoded}));
+        Bench::clobber(decoded);
+    });
+
+    snprintf(name, sizeof(name), "%sdecoder_feed", prefix);
+    suite.run(name, data.size(), {{"zero_density", density}}, [&]()
+    {
+        Cobs::Decoder<V> decoder;
+        size_t i = 0;
+        for (const auto byte : frame)
+        {
+            decoder.feed(byte, [&](uint8_t value) { decoded[i++] = value; });
+        }
+        Bench::clobber(decoded);
+    });
+}
+
+int main(int argc, char ** argv)
+{
+    Bench::Suite suite("cobs", argc, argv);
+    for (const double density : {0.0, 0.01, 0.1, 0.5})
+    {
+        const auto data = Bench::bytes(1024, density);
+        benchVariant<Cobs::Variant::Cobs>(suite, "", data, density);
+        benchVariant<Cobs::Variant::CobsR>(suite, "cobsr_", data, density);
+        benchVariant<Cobs::Variant::Zpe>(suite, "zpe_", data, density);
+    }
+}
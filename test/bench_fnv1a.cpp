@@ -0,0 +1,39 @@
+/**
+\file
+
+Throughput of the FNV-1A checksum, see test/bench.hpp.
+
+*/
+#include "checksum.hpp"
+#include "fnv1a.hpp"
+
+#include "bench.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <span>
+
+int main(int argc, char ** argv)
+{
+    Bench::Suite suite("fnv1a", argc, argv);
+    for (const size_t size : {16, 256, 4096})
+    {
+        auto data = Bench::bytes(size, 0.0);
+        suite.run("checksum", size, {}, [&]()
+        {
+            Bench::clobber(data);
+            Bench::keep(Fnv1a::checksum(std::span{data}));
+        });
+        suite.run("checker", size, {}, [&]()
+        {
+            Bench::clobber(data);
+            Checksum::Checker<Checksum::Kind::Fnv1a> checker;
+            for (const auto byte : data)
+            {
+                checker.feed(byte);
+            }
+            Bench::keep(checker);
+        });
+    }
+}
@@ -32,17 +32,20 @@ There are a few parts to this code:
 #include <stdio.h>
 
 #include <algorithm>
+#include <array>
 #include <charconv>
 #include <concepts>
 #include <fstream>
 #include <iostream>
 #include <optional>
+#include <random>
 #include <ranges>
 #include <regex>
 #include <string>
 #include <string_view>
 
 using namespace std::literals;
+using Cbor::ArrayView;
 
 constexpr std::string_view RED = "\x1b[31m";
 constexpr std::string_view YELLOW = "\x1b[33m";
@@ -148,6 +151,70 @@ struct Parse<std::span<uint8_t>>
     }
 };
 
+/// Parse a text string (no escapes)
+template<>
+struct Parse<std::string_view>
+{
+    static std::optional<std::string_view> parse(std::string s)
+    {
+        static std::string into;
+        std::regex literal{"\"([^\"\\\\]*)\""};
+        std::smatch m;
+        if (std::regex_match(s.cbegin(), s.cend(), m, literal))
+        {
+            into = m[1];
+            return {into};
+        }
+        return {};
+    }
+};
+
+/// Parse a flat array of integers, into a view of them encoded
+template<>
+struct Parse<Cbor::ArrayView<int>>
+{
+    static std::optional<Cbor::ArrayView<int>> parse(std::string s)
+    {
+        static std::vector<uint8_t> into;
+        std::regex literal{"\\[([-0-9, ]*)\\]"};
+        std::regex number{"-?[0-9]+"};
+        std::smatch m;
+        if (!std::regex_match(s.cbegin(), s.cend(), m, literal))
+        {
+            return {};
+        }
+        const std::string items = m[1];
+        std::vector<int> values;
+        for (auto it = std::sregex_iterator{items.cbegin(), items.cend(), number};
+             it != std::sregex_iterator{}; ++it)
+        {
+            auto value = Parse<int>::parse(it->str());
+            if (!value) return {};
+            values.push_back(*value);
+        }
+        into.assign(values.size() * Cbor::Cbor<int>::maxSize(), 0);
+        std::span<uint8_t> buf{into};
+        for (int value : values)
+        {
+            if (!Cbor::Cbor<int>::encode(value, buf)) return {};
+        }
+        const std::span<uint8_t> encoded{into.data(), into.size() - buf.size()};
+        return {Cbor::ArrayView<int>{encoded, values.size()}};
+    }
+};
+
+static std::ostream & operator<<(std::ostream & os, const Cbor::ArrayView<int> view)
+{
+    const char * sep = "";
+    os << "[";
+    for (int value : view)
+    {
+        os << sep << value;
+        sep = ", ";
+    }
+    return os << "]";
+}
+
 static std::ostream & operator<<(std::ostream & os, const std::span<uint8_t> span)
 {
     auto fill = os.fill();
@@ -163,6 +230,379 @@ static std::ostream & operator<<(std::ostream & os, const std::span<uint8_t> spa
     return os;
 }
 
+/// Like a status struct, with more fields than fit on the fingers
+struct Wide
+{
+    int f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11;
+    unsigned u0, u1, u2, u3, u4, u5, u6, u7;
+    bool b0, b1;
+    char initial;
+    std::array<uint16_t, 2> pair;
+};
+static_assert(Aggregate::fieldCount<Wide>() == 24);
+static_assert(Aggregate::fieldCount<Cbor::Undefined>() == 0);
+static_assert(Cbor::Cbor<Wide>::maxSize() == 2 + 12 * 5 + 8 * 5 + 2 * 1 + 2 + (1 + 2 * 3));
+static_assert(Cbor::Cbor<std::tuple<uint8_t, bool>>::maxSize() == 1 + 2 + 1);
+static_assert(!Cbor::Bounded<std::string_view>);
+
+/// Round trip an aggregate with more than 20 fields
+static bool testAggregate()
+{
+    const Wide wide{
+        0, -1, 2, -3, 4, -5, 6, -7, 8, -9, 1000, -1000,
+        0, 1, 23, 24, 255, 256, 65535, 65536,
+        true, false, 'w', {1, 2}};
+    std::array<uint8_t, 128> buf{};
+    std::span<uint8_t> out{buf};
+    if (!Cbor::Cbor<Wide>::encode(wide, out))
+    {
+        std::cerr << RED << "Failed to encode aggregate" << RESET << "\n";
+        return false;
+    }
+    std::span<uint8_t> in{buf.data(), buf.size() - out.size()};
+    if (in[0] != 0x98 || in[1] != 24)
+    {
+        std::cerr << RED << "Aggregate isn't a 24 element array" << RESET << "\n";
+        return false;
+    }
+    const auto decoded = Cbor::Cbor<Wide>::decode(in);
+    if (!decoded || !in.empty() || Aggregate::tie(*decoded) != Aggregate::tie(wide))
+    {
+        std::cerr << RED << "Failed to decode aggregate" << RESET << "\n";
+        return false;
+    }
+    // Too small for the worst case, so it checks each field instead
+    std::vector<uint8_t> exact(buf.size() - out.size());
+    std::span<uint8_t> tight{exact};
+    if (!Cbor::Cbor<Wide>::encode(wide, tight) || !tight.empty() ||
+        !std::ranges::equal(exact, std::span{buf}.first(exact.size())))
+    {
+        std::cerr << RED << "Checked and unchecked aggregate encodings differ" << RESET << "\n";
+        return false;
+    }
+    tight = std::span{exact}.first(exact.size() - 1);
+    if (Cbor::Cbor<Wide>::encode(wide, tight))
+    {
+        std::cerr << RED << "Encoded aggregate into too small a buffer" << RESET << "\n";
+        return false;
+    }
+    return true;
+}
+
+/// Round trip delta encoded sequences, including the wrap around between
+/// the extremes
+static bool testDeltas()
+{
+    const std::array<int, 3> small{1000, 1001, 999};
+    const std::array<uint8_t, 8> expected{0xD9, 0xCC, 0xF0, 0x44, 0xD0, 0x0F, 0x02, 0x03};
+    std::array<uint8_t, 128> buf{};
+    std::span<uint8_t> out{buf};
+    if (!Cbor::Cbor<Cbor::Deltas<int>>::encode({small}, out) ||
+        !std::ranges::equal(std::span{buf}.first(buf.size() - out.size()), expected))
+    {
+        std::cerr << RED << "Wrong delta encoding" << RESET << "\n";
+        return false;
+    }
+
+    const std::array<int64_t, 5> extremes{INT64_MAX, INT64_MIN, 0, -1, INT64_MAX};
+    out = buf;
+    if (!Cbor::Cbor<Cbor::Deltas<int64_t>>::encode({extremes}, out))
+    {
+        std::cerr << RED << "Failed to encode deltas" << RESET << "\n";
+        return false;
+    }
+    std::span<uint8_t> in{buf.data(), buf.size() - out.size()};
+    const auto decoded = Cbor::Cbor<Cbor::DeltaView<int64_t>>::decode(in);
+    if (!decoded || !in.empty() || !std::ranges::equal(*decoded, extremes))
+    {
+        std::cerr << RED << "Failed to decode deltas" << RESET << "\n";
+        return false;
+    }
+    // INT64_MAX doesn't fit
+    in = {buf.data(), buf.size() - out.size()};
+    if (Cbor::Cbor<Cbor::DeltaView<int32_t>>::decode(in))
+    {
+        std::cerr << RED << "Decoded deltas out of range" << RESET << "\n";
+        return false;
+    }
+    // Truncated varint
+    std::array<uint8_t, 5> truncated{0xD9, 0xCC, 0xF0, 0x41, 0x80};
+    in = truncated;
+    if (Cbor::Cbor<Cbor::DeltaView<int>>::decode(in))
+    {
+        std::cerr << RED << "Decoded truncated deltas" << RESET << "\n";
+        return false;
+    }
+    return true;
+}
+
+static_assert(Half::fromFloat(1.0f) == 0x3C00 && Half::toFloat(0x3C00) == 1.0f);
+
+/// Software half floats, against `_Float16` where the compiler has it
+static bool testHalf()
+{
+    bool ok = true;
+    for (uint32_t bits = 0; bits <= UINT16_MAX; ++bits)
+    {
+        const auto half = static_cast<uint16_t>(bits);
+        const float value = Half::toFloat(half);
+        const uint16_t back = Half::fromFloat(value);
+        const uint16_t backDouble = Half::fromFloat(static_cast<double>(value));
+        const bool nan = (half & 0x7C00) == 0x7C00 && (half & 0x3FF) != 0;
+        const bool same = nan
+            ? std::isnan(value) && back == (half | 0x200) && backDouble == back
+            : back == half && backDouble == half;
+#if defined(FLT16_MIN)
+        const bool native = nan || std::bit_cast<uint16_t>(static_cast<_Float16>(value)) == half;
+#else
+        const bool native = true;
+#endif
+        if (!same || !native)
+        {
+            std::cerr << RED;
+            fprintf(stderr, "Half %04X round tripped to %g %04X %04X",
+                half, static_cast<double>(value), back, backDouble);
+            std::cerr << RESET << "\n";
+            ok = false;
+        }
+    }
+
+    // Rounding, ties to even, overflow and underflow
+    const std::array<std::pair<float, uint16_t>, 10> rounding{{
+        {1.0f + 0x1p-11f, 0x3C00}, {1.0f + 0x3p-11f, 0x3C02}, {1.0f + 0x1p-12f, 0x3C00},
+        {65519.0f, 0x7BFF}, {65520.0f, 0x7C00}, {-1e10f, 0xFC00},
+        {0x1p-25f, 0x0000}, {0x1.000002p-25f, 0x0001}, {-0x3p-25f, 0x8002},
+        {0x1.FFCp-15f, 0x0400},
+    }};
+    for (const auto & [value, expected] : rounding)
+    {
+        const uint16_t got = Half::fromFloat(value);
+        if (got != expected)
+        {
+            std::cerr << RED;
+            fprintf(stderr, "Half of %a is %04X not %04X", static_cast<double>(value), got, expected);
+            std::cerr << RESET << "\n";
+            ok = false;
+        }
+    }
+    // Double rounding through float would give 0x3C01
+    if (Half::fromFloat(1.0 + 0x1p-11 + 0x1p-40) != 0x3C01)
+    {
+        std::cerr << RED << "Half of a double rounded twice" << RESET << "\n";
+        ok = false;
+    }
+
+#if defined(FLT16_MIN)
+    std::mt19937 rng{1};
+    for (int i = 0; i < 1000000; ++i)
+    {
+        const uint32_t bits = rng();
+        const float value = std::bit_cast<float>(bits);
+        const auto expected = std::bit_cast<uint16_t>(static_cast<_Float16>(value));
+        if (!std::isnan(value) && Half::fromFloat(value) != expected)
+        {
+            std::cerr << RED;
+            fprintf(stderr, "Half of %a is %04X not %04X",
+                static_cast<double>(value), Half::fromFloat(value), expected);
+            std::cerr << RESET << "\n";
+            ok = false;
+            break;
+        }
+    }
+#endif
+
+    // Lossy, but always 3 bytes
+    std::array<uint8_t, 8> buf{};
+    std::span<uint8_t> out{buf};
+    const std::array<uint8_t, 3> expected{0xF9, 0x3C, 0x66};
+    if (!Cbor::Cbor<Cbor::AsHalf<float>>::encode({1.1f}, out) ||
+        !std::ranges::equal(std::span{buf}.first(buf.size() - out.size()), expected))
+    {
+        std::cerr << RED << "Wrong lossy half encoding" << RESET << "\n";
+        ok = false;
+    }
+    std::span<uint8_t> in{buf.data(), buf.size() - out.size()};
+    const auto decoded = Cbor::Cbor<Cbor::AsHalf<double>>::decode(in);
+    if (!decoded || !in.empty() || decoded->value != 0x1.198p0)
+    {
+        std::cerr << RED << "Failed to decode lossy half" << RESET << "\n";
+        ok = false;
+    }
+    return ok;
+}
+
+/// Walk item headers, reject malformed input and skip unknown elements
+static bool testReader()
+{
+    // [_ 1, [2, 3], [_ 4, 5]]
+    std::vector<uint8_t> nested{0x9F, 0x01, 0x82, 0x02, 0x03, 0x9F, 0x04, 0x05, 0xFF, 0xFF};
+    const std::array<std::pair<Cbor::Major, size_t>, 10> walk{{
+        {Cbor::Major::Array, 0}, {Cbor::Major::U64, 1}, {Cbor::Major::Array, 1},
+        {Cbor::Major::U64, 2}, {Cbor::Major::U64, 2}, {Cbor::Major::Array, 1},
+        {Cbor::Major::U64, 2}, {Cbor::Major::U64, 2}, {Cbor::Major::Simple, 2},
+        {Cbor::Major::Simple, 1},
+    }};
+    Cbor::Reader reader{nested};
+    for (const auto & [major, depth] : walk)
+    {
+        const size_t before = reader.depth();
+        const auto item = reader.next();
+        if (!item || item->major != major || before != depth)
+        {
+            std::cerr << RED << "Reader walked the wrong items" << RESET << "\n";
+            return false;
+        }
+    }
+    if (reader.depth() != 0 || !reader.rest().empty() || reader.next())
+    {
+        std::cerr << RED << "Reader didn't finish at the end" << RESET << "\n";
+        return false;
+    }
+
+    const std::vector<std::vector<uint8_t>> malformed{
+        {0xFF},                                 // Break outside indefinite
+        {0x82, 0x01},                           // Truncated array
+        {0x1C},                                 // Reserved minor
+        {0x1F},                                 // Indefinite integer
+        {0xBF, 0x01, 0xFF},                     // Key without a value
+        {0x5F, 0x61, 0x61, 0xFF},               // Text chunk in bytes
+        {0x43, 0x01},                           // String past the end
+        {0xF8, 0x10},                           // Two byte simple below 32
+        {0x9B, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},  // Huge length
+        {0x01, 0x02},                           // Trailing item
+    };
+    for (auto bytes : malformed)
+    {
+        if (Cbor::Reader::wellFormed(bytes))
+        {
+            std::cerr << RED << "Malformed CBOR accepted" << RESET << "\n";
+            return false;
+        }
+    }
+    std::vector<uint8_t> deep(Cbor::Reader::maxDepth + 1, 0x81);
+    deep.push_back(0x00);
+    if (Cbor::Reader::wellFormed(deep) ||
+        !Cbor::Reader::wellFormed(std::span{deep}.subspan(1)))
+    {
+        std::cerr << RED << "Reader depth limit wrong" << RESET << "\n";
+        return false;
+    }
+
+    // [1, {"a": h'00'}, [_ 2]] as a one element tuple, and [_ 1, "x"]
+    std::vector<uint8_t> extra{0x83, 0x01, 0xA1, 0x61, 0x61, 0x41, 0x00, 0x9F, 0x02, 0xFF};
+    std::vector<uint8_t> extraIndefinite{0x9F, 0x01, 0x61, 0x78, 0xFF};
+    for (std::span<uint8_t> in : {std::span{extra}, std::span{extraIndefinite}})
+    {
+        const auto decoded = Cbor::Cbor<std::tuple<int>>::decode(in);
+        if (!decoded || std::get<0>(*decoded) != 1 || !in.empty())
+        {
+            std::cerr << RED << "Failed to skip extra tuple elements" << RESET << "\n";
+            return false;
+        }
+    }
+    std::span<uint8_t> tooFew{extra.data(), 2};
+    tooFew[0] = 0x81;
+    if (Cbor::Cbor<std::tuple<int, int>>::decode(tooFew))
+    {
+        std::cerr << RED << "Decoded a tuple from too few elements" << RESET << "\n";
+        return false;
+    }
+    return true;
+}
+
+/// Decode a tuple in place, stopping at the first element that fails
+static bool testDecodeInto()
+{
+    // [7, "hi", [1, 2]]
+    std::vector<uint8_t> good{0x83, 0x07, 0x62, 0x68, 0x69, 0x82, 0x01, 0x02};
+    std::tuple<int, std::string_view, std::tuple<int, int>> into{};
+    std::span<uint8_t> in{good};
+    if (!Cbor::decodeInto(into, in) || !in.empty() ||
+        into != std::tuple{7, "hi"sv, std::tuple{1, 2}})
+    {
+        std::cerr << RED << "Failed to decode a tuple in place" << RESET << "\n";
+        return false;
+    }
+    // [8, true, [3, 4]], stops at true without touching the rest
+    std::vector<uint8_t> bad{0x83, 0x08, 0xF5, 0x82, 0x03, 0x04};
+    in = bad;
+    if (Cbor::decodeInto(into, in) || std::get<0>(into) != 8 ||
+        std::get<2>(into) != std::tuple{1, 2} || in.size() != 3)
+    {
+        std::cerr << RED << "Decoding in place didn't stop at the failure" << RESET << "\n";
+        return false;
+    }
+    // [5, 6] into three elements, then [5, true, 7] stopping at true
+    std::array<int, 3> arr{1, 2, 3};
+    std::vector<uint8_t> shortArr{0x82, 0x05, 0x06};
+    in = shortArr;
+    std::vector<uint8_t> badArr{0x83, 0x05, 0xF5, 0x07};
+    std::span<uint8_t> badIn{badArr};
+    if (Cbor::decodeInto(arr, in) || arr != std::array{1, 2, 3} ||
+        Cbor::decodeInto(arr, badIn) || arr != std::array{5, 2, 3} || badIn.size() != 1)
+    {
+        std::cerr << RED << "Decoding an array didn't check its elements" << RESET << "\n";
+        return false;
+    }
+    return true;
+}
+
+/// Only takes bytes through `put`, like a sink with no contiguous room.
+struct PutOnlySink
+{
+    std::vector<uint8_t> bytes;
+
+    bool put(std::span<const uint8_t> more)
+    {
+        bytes.insert(bytes.end(), more.begin(), more.end());
+        return true;
+    }
+    uint8_t * reserve(size_t) { return nullptr; }
+    void commit(size_t) { }
+};
+
+static bool testSinks()
+{
+    const std::array<int32_t, 4> values{1000, -70000, 3, 2000000000};
+    using Value = std::tuple<Wide, std::string_view, Cbor::Deltas<int32_t>, std::array<int32_t, 4>, double>;
+    const Value value{Wide{}, "text"sv, Cbor::Deltas<int32_t>{values}, values, 1.5};
+    std::vector<uint8_t> buf(256);
+    std::span<uint8_t> rest{buf};
+    if (!Cbor::Cbor<Value>::encode(value, rest))
+    {
+        std::cerr << RED << "Failed to encode for the sinks" << RESET << "\n";
+        return false;
+    }
+    const auto expected = std::span{buf}.first(buf.size() - rest.size());
+    PutOnlySink putOnly;
+    Cbor::SinkRef ref{putOnly};
+    if (!Cbor::Cbor<Value>::encode(value, ref) ||
+        !std::ranges::equal(putOnly.bytes, expected) ||
+        Cbor::encodedSize(value) != expected.size())
+    {
+        std::cerr << RED << "Sinks disagree with encoding to a span" << RESET << "\n";
+        return false;
+    }
+    // Count the elements, for a definite length header the second time
+    Cbor::CountingSink counter;
+    size_t count = 0;
+    {
+        Cbor::Sequence<Cbor::Major::Array, Cbor::CountingSink> seq(counter);
+        for (int i = 0; i < 30; i += 7)
+        {
+            seq.encode(i);
+        }
+        count = seq.count();
+    }
+    // Indefinite length header, 0 to 21 embedded, 28 in two bytes and the break
+    if (count != 5 || counter.count != 1 + 4 + 2 + 1)
+    {
+        std::cerr << RED << "Miscounted a sequence" << RESET << "\n";
+        return false;
+    }
+    return true;
+}
+
 int main(int argc, char ** argv)
 {
     bool ok = true;
@@ -223,6 +663,24 @@ int main(int argc, char ** argv)
             continue;
         }
         std::span encoded{bytes};
+        if (!Cbor::Reader::wellFormed(encoded))
+        {
+            std::cerr << RED << "Reader failed on " << m[Encoded] << RESET << "\n";
+            ok = false;
+        }
+        // The 32 bit unpack agrees with the 64 bit one when the argument fits
+        std::span<uint8_t> in64{bytes};
+        std::span<uint8_t> in32{bytes};
+        const auto item64 = Cbor::unpack(in64);
+        const auto item32 = Cbor::unpack32(in32);
+        const bool fits = item64 && item64->minor != Cbor::Minor::EightByteFollows;
+        if (fits != item32.has_value() ||
+            (item32 && (item32->major != item64->major || item32->minor != item64->minor ||
+                        item32->value != item64->value || in32.size() != in64.size())))
+        {
+            std::cerr << RED << "unpack32 disagrees on " << m[Encoded] << RESET << "\n";
+            ok = false;
+        }
 
         // Dispatch the test on each type
 #define DISPATCH(TYPE)                                                               \
@@ -230,7 +688,8 @@ int main(int argc, char ** argv)
         {                                                                            \
             std::optional<TYPE> expected = Parse<TYPE>::parse(m[Decoded]);           \
             std::optional<TYPE> decoded = Cbor::Cbor<TYPE>::decode(encoded);         \
-            if (!decoded || !expected || !eq(*decoded, *expected))                   \
+            if (!decoded || !expected || !eq(*decoded, *expected) ||                 \
+                !encoded.empty())                                                    \
             {                                                                        \
                 std::cerr << RED << "Failed to decode " << m[Encoded] << "\tinto\t"  \
                           << *expected << "\tgot\t" << *decoded << RESET << "\n";    \
@@ -251,6 +710,12 @@ int main(int argc, char ** argv)
                 std::cerr << RESET << "\n";                                          \
                 ok = false;                                                          \
             }                                                                        \
+            if (Cbor::encodedSize(*expected) != bytes.size())                        \
+            {                                                                        \
+                std::cerr << RED << "Miscounted encoding " << m[Decoded] << RESET    \
+                          << "\n";                                                   \
+                ok = false;                                                          \
+            }                                                                        \
         }
         DISPATCH(uint64_t)
         else DISPATCH(int64_t)
@@ -261,6 +726,8 @@ int main(int argc, char ** argv)
         else DISPATCH(float)
         else DISPATCH(double)
         else DISPATCH(std::span<uint8_t>)
+        else DISPATCH(std::string_view)
+        else DISPATCH(ArrayView<int>)
         else if (m[Type] != "N/A" && m[Type].str().substr(0, 4) != "Skip")
         {
             std::cout << YELLOW << "Don't know how to test "
@@ -268,5 +735,11 @@ int main(int argc, char ** argv)
                       << RESET << "\n";
         }
     }
+    ok = testAggregate() && ok;
+    ok = testDeltas() && ok;
+    ok = testHalf() && ok;
+    ok = testReader() && ok;
+    ok = testDecodeInto() && ok;
+    ok = testSinks() && ok;
     return ok ? 0 : 1;
 }
@@ -0,0 +1,68 @@
+import binascii
+
+import pytest
+from conftest import ChecksumKind, LibChecksum
+from fnvhash import fnv1a_32
+from hypothesis import given
+from hypothesis import strategies as st
+
+
+def crc32c(data: bytes) -> int:
+    "Bit at a time reference, independent of the tables"
+    crc = 0xFFFFFFFF
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = (crc >> 1) ^ (0x82F63B78 if crc & 1 else 0)
+    return crc ^ 0xFFFFFFFF
+
+
+SIZES = {
+    ChecksumKind.FNV1A: 4,
+    ChecksumKind.CRC32C: 4,
+    ChecksumKind.CRC32C_HW: 4,
+    ChecksumKind.CRC16: 2,
+    ChecksumKind.NONE: 0,
+}
+
+
+def reference(kind: ChecksumKind, data: bytes) -> int:
+    match kind:
+        case ChecksumKind.FNV1A:
+            return fnv1a_32(data)
+        case ChecksumKind.CRC32C | ChecksumKind.CRC32C_HW:
+            return crc32c(data)
+        case ChecksumKind.CRC16:
+            return binascii.crc_hqx(data, 0xFFFF)
+        case ChecksumKind.NONE:
+            return 0
+
+
+@pytest.mark.parametrize(
+    argnames=("kind", "expected"),
+    argvalues=[
+        (ChecksumKind.CRC32C, 0xE3069283),
+        (ChecksumKind.CRC32C_HW, 0xE3069283),
+        (ChecksumKind.CRC16, 0x29B1),
+    ],
+)
+def test_check_value(libchecksum: LibChecksum, kind, expected):
+    assert libchecksum.compute(kind, b"123456789") == expected
+
+
+@pytest.mark.parametrize(argnames="kind", argvalues=list(ChecksumKind))
+@pytest.mark.parametrize(argnames="bulk", argvalues=[False, True])
+@given(data=st.binary(max_size=100))
+def test_compute(libchecksum: LibChecksum, kind, bulk, data):
+    assert libchecksum.compute(kind, data, bulk) == reference(kind, data)
+
+
+@pytest.mark.parametrize(argnames="kind", argvalues=list(ChecksumKind))
+@given(data=st.binary(max_size=100))
+def test_check(libchecksum: LibChecksum, kind, data):
+    size = SIZES[kind]
+    framed = data + reference(kind, data).to_bytes(length=size, byteorder="little")
+    assert libchecksum.check(kind, framed)
+    if size > 0:
+        assert not libchecksum.check(kind, framed[:-1])
+        assert not libchecksum.check(kind, bytes([framed[0] ^ 1]) + framed[1:])
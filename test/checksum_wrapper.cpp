@@ -0,0 +1,69 @@
+#include "checksum_wrapper.hpp"
+
+#include "checksum.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <span>
+
+template<Checksum::Kind K>
+static uint32_t compute(std::span<const uint8_t> data, bool bulk)
+{
+    using P = Checksum::Policy<K>;
+    auto state = P::initial;
+    if (bulk)
+    {
+        state = P::update(state, data);
+    }
+    else
+    {
+        for (const auto byte : data)
+        {
+            state = P::feed(state, byte);
+        }
+    }
+    return P::value(state);
+}
+
+template<Checksum::Kind K>
+static bool check(std::span<const uint8_t> data)
+{
+    Checksum::Checker<K> checker;
+    for (const auto byte : data)
+    {
+        checker.feed(byte);
+    }
+    // Both ways of checking should agree
+    return checker.check() && Checksum::checkAtEnd<K>(data);
+}
+
+template<typename Fn>
+static auto dispatch(uint8_t kind, Fn && fn)
+{
+    using enum Checksum::Kind;
+    switch (static_cast<Checksum::Kind>(kind))
+    {
+    case Fnv1a: return fn.template operator()<Fnv1a>();
+    case Crc32c: return fn.template operator()<Crc32c>();
+#if defined(__SSE4_2__) || defined(__ARM_FEATURE_CRC32)
+    case Crc32cHw: return fn.template operator()<Crc32cHw>();
+#else
+    // Without the instructions, check the portable one in its place
+    case Crc32cHw: return fn.template operator()<Crc32c>();
+#endif
+    case Crc16: return fn.template operator()<Crc16>();
+    case None: break;
+    }
+    return fn.template operator()<None>();
+}
+
+uint32_t checksumCompute(uint8_t kind, const uint8_t * data, size_t len, bool bulk)
+{
+    return dispatch(kind, [&]<Checksum::Kind K>() { return compute<K>({data, len}, bulk); });
+}
+
+bool checksumCheck(uint8_t kind, const uint8_t * data, size_t len)
+{
+    return dispatch(kind, [&]<Checksum::Kind K>() { return check<K>({data, len}); });
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+extern "C"
+{
+    /// Checksum of the data using `Checksum::Kind` `kind`, fed a byte at
+    /// a time if `bulk` is false.
+    uint32_t checksumCompute(uint8_t kind, const uint8_t * data, size_t len, bool bulk);
+    bool checksumCheck(uint8_t kind, const uint8_t * data, size_t len);
+}
@@ -163,14 +163,119 @@ static bool test_normal_operation()
     return true;
 }
 
+/// \test
+/// Packets longer than 255 bytes need a 16-bit size, check it is written
+/// and read back the same way.
+static bool test_large_pkts()
+{
+    constexpr size_t LARGE_PKT_SIZE = 1000;
+    static CircularBuffer<uint8_t, 4096, LARGE_PKT_SIZE> large;
+    static_assert(large.sizeBytes == sizeof(uint16_t));
+    std::optional<decltype(large)::Frame> largeFrame;
+
+    for (const size_t len : {LARGE_PKT_SIZE, size_t{300}, size_t{1}})
+    {
+        for (size_t i = 0; i < len; ++i)
+        {
+            large.push_back(static_cast<uint8_t>(i));
+        }
+        assert(!large.dropping());
+        large.notify();
+    }
+    for (const size_t len : {LARGE_PKT_SIZE, size_t{300}, size_t{1}})
+    {
+        assert(large.get_frame(largeFrame));
+        size_t i = 0;
+        for (const auto byte : *largeFrame)
+        {
+            assert(byte == static_cast<uint8_t>(i));
+            ++i;
+        }
+        assert(i == len);
+    }
+    largeFrame.reset();
+    assert(large.empty());
+
+    for (size_t i = 0; i <= LARGE_PKT_SIZE; ++i)
+    {
+        large.push_back(static_cast<uint8_t>(i));
+    }
+    assert(large.dropping());
+    return true;
+}
+
+/// \test
+/// Writing a packet in place after reserving space, including wrapping
+/// around the end of the buffer, and failing to reserve too much.
+static bool test_reserve()
+{
+    frame.reset();
+    buf.reset();
+
+    // Move the cursors along so that the next packet wraps
+    std::ranges::copy(u8s{1, 2, 3, 4}, ins);
+    buf.notify();
+    assert(buf.get_frame(frame));
+    frame.reset();
+
+    assert(buf.reserve(MAX_PKT_SIZE));
+    buf.reserved(0) = 5;
+    buf.reserved(1) = 6;
+    buf.reserved(2) = 7;
+    buf.commit(2);
+    assert(!buf.dropping());
+    buf.notify();
+    assert(buf.get_frame(frame));
+    u8s expected{5, 6};
+    assert(std::equal(expected.begin(), expected.end(), frame->begin(), frame->end()));
+    frame.reset();
+
+    assert(!buf.reserve(MAX_PKT_SIZE + 1));
+    assert(buf.dropping());
+    buf.reset_dropped();
+    assert(buf.empty());
+    return true;
+}
+
+/// \test
+/// The segments of a frame are the frame in place, split where it wraps.
+static bool test_segments()
+{
+    frame.reset();
+    buf.reset();
+
+    std::ranges::copy(u8s{1, 2, 3}, ins);
+    buf.notify();
+    assert(buf.get_frame(frame));
+    const auto [head, tail] = frame->segments();
+    u8s expected{1, 2, 3};
+    assert(std::ranges::equal(head, expected) && tail.empty());
+    frame.reset();
+
+    // After its size byte at 4, so wraps after 4, 5 and 6
+    std::ranges::copy(u8s{4, 5, 6, 7}, ins);
+    buf.notify();
+    assert(buf.get_frame(frame));
+    const auto wrapped = frame->segments();
+    u8s expectedHead{4, 5, 6};
+    u8s expectedTail{7};
+    assert(std::ranges::equal(wrapped[0], expectedHead) && std::ranges::equal(wrapped[1], expectedTail));
+    frame.reset();
+    return true;
+}
+
 int main()
 {
     if (
         test_insert_more_than_max_pkt_size() &&
         test_fill_queue_max_pkt_size() &&
         test_fill_queue_small_pkts() &&
-        test_normal_operation()
+        test_normal_operation() &&
+        test_large_pkts() &&
+        test_reserve() &&
+        test_segments()
     ) {
         return 0;
     }
+    return 1;
 }
@@ -5,6 +5,7 @@
 #include <stdint.h>
 #include <stdio.h>
 
+#include <algorithm>
 #include <array>
 #include <span>
 
@@ -33,4 +34,27 @@ int main()
     for (n = 70 - n; n > 0; --n) { printf("="); }
     printf("\n");
     hexdump(std::span{enc});
+
+    // The bulk encoder should give the same as the iterator
+    std::array<uint8_t, Cobs::maxEncodedSize(buf.size())> bulk;
+    const auto bulkLen = Cobs::encode(std::span{buf}, std::span{bulk});
+    if (!bulkLen || *bulkLen != i || !std::equal(enc.begin(), enc.begin() + i, bulk.begin()))
+    {
+        printf("Bulk encode differs (%ld bytes)\n", bulkLen.value_or(0));
+        hexdump(std::span{bulk});
+        return 1;
+    }
+
+    // And so should the byte at a time writer
+    std::array<uint8_t, Cobs::maxEncodedSize(buf.size())> pushed;
+    const auto out = [&](size_t index) -> uint8_t & { return pushed[index]; };
+    Cobs::Writer<Cobs::Variant::Cobs, decltype(out)> writer{out};
+    writer.push(std::span{buf});
+    const size_t pushedLen = writer.finish();
+    if (pushedLen != i || !std::equal(enc.begin(), enc.begin() + i, pushed.begin()))
+    {
+        printf("Writer encode differs (%ld bytes)\n", pushedLen);
+        hexdump(std::span{pushed});
+        return 1;
+    }
 }
@@ -1,6 +1,6 @@
 import pytest
-from cobs import cobs
-from conftest import LibCobs, create_string_buffer
+from cobs import cobs, cobsr
+from conftest import CobsVariant, LibCobs, create_string_buffer
 from hypothesis import given, example
 from hypothesis import strategies as st
 
@@ -11,6 +11,30 @@ def test_encode(libcobs: LibCobs, data):
     assert encoded == cobs.encode(data)
 
 
+@given(st.binary())
+@example(b"\0" * 254)
+@example(b"\1" * 254)
+@example(b"\1" * 254 + b"\0")
+@example(bytes(range(1, 256)) * 3)
+def test_encode_bulk(libcobs: LibCobs, data):
+    encoded = libcobs.encode_bulk(data)
+    assert encoded == cobs.encode(data)
+
+
+@given(st.binary(), st.data(), st.booleans())
+@example(b"\1" * 300, None, False)
+@example(b"\1" * 300, None, True)
+def test_encode_gather(libcobs: LibCobs, data, split, iterator):
+    head, tail = 1, 4
+    if split is not None:
+        head = split.draw(st.integers(min_value=0, max_value=len(data)))
+        tail = split.draw(st.integers(min_value=0, max_value=len(data) - head))
+    elif len(data) < head + tail:
+        head, tail = 0, 0
+    encoded = libcobs.encode_gather(data, head, tail, iterator)
+    assert encoded == cobs.encode(data)
+
+
 @pytest.mark.parametrize(
     "data,out_len",
     [
@@ -52,3 +76,92 @@ def test_edge_case_bigger_buffer(libcobs: LibCobs, data):
 def test_decode(libcobs: LibCobs, data):
     encoded = cobs.encode(data)
     assert libcobs.decode(encoded) == data
+
+
+@given(st.binary(), st.integers(min_value=1, max_value=300))
+@example(b"\0" * 256, 1)
+@example(b"\1" * 256, 255)
+@example(b"\1" * 600, 7)
+def test_decode_chunked(libcobs: LibCobs, data, chunk):
+    encoded = cobs.encode(data) + b"\0"
+    assert libcobs.decode_chunked(encoded, chunk) == data
+
+
+
+@given(st.binary(min_size=1), st.integers(min_value=1, max_value=300), st.data())
+def test_decode_truncated(libcobs: LibCobs, data, chunk, cut):
+    encoded = cobs.encode(data)
+    assert not libcobs.decode_truncated(encoded + b"\0", chunk)
+    # Cutting a frame short leaves the last header pointing past the
+    # delimiter, unless the cut is just before a header
+    end = cut.draw(st.integers(min_value=1, max_value=len(encoded) - 1))
+    headers = set()
+    idx = 0
+    while idx < len(encoded):
+        headers.add(idx)
+        idx += encoded[idx]
+    assert libcobs.decode_truncated(encoded[:end] + b"\0", chunk) == (
+        end not in headers
+    )
+
+# Plain binaries rarely have the zero pairs COBS/ZPE is for
+zero_heavy = st.lists(
+    st.sampled_from([b"\0", b"\0\0", b"\1", b"\xff", b"\1" * 30, b"\1" * 223])
+).map(b"".join)
+
+
+@given(st.binary(), st.booleans())
+@example(b"\1" * 254, False)
+@example(b"\1" * 253 + b"\xff", True)
+@example(b"\1\xff", False)
+def test_encode_cobsr(libcobs: LibCobs, data, iterator):
+    encoded = libcobs.encode_variant(CobsVariant.COBSR, data, iterator)
+    assert encoded == cobsr.encode(data)
+
+
+@given(st.binary(), st.booleans())
+@example(b"\1\xff", False)
+@example(b"\1\xff", True)
+def test_decode_cobsr(libcobs: LibCobs, data, bulk):
+    encoded = cobsr.encode(data) + b"\0"
+    assert libcobs.decode_variant(CobsVariant.COBSR, encoded, bulk) == data
+
+
+@given(st.binary() | zero_heavy, st.booleans(), st.booleans())
+@example(b"\1" * 30 + b"\0\0", False, False)
+@example(b"\1" * 31 + b"\0\0", True, True)
+@example(b"\0", False, True)
+@example(b"\1" * 223, True, False)
+def test_zpe_round_trip(libcobs: LibCobs, data, iterator, bulk):
+    encoded = libcobs.encode_variant(CobsVariant.ZPE, data, iterator)
+    assert encoded == libcobs.encode_variant(CobsVariant.ZPE, data, not iterator)
+    assert b"\0" not in encoded
+    decoded = libcobs.decode_variant(CobsVariant.ZPE, encoded + b"\0", bulk)
+    assert decoded == data
+
+
+@given(
+    st.binary() | zero_heavy, st.data(), st.booleans(), st.sampled_from(CobsVariant)
+)
+# A zero pair split across spans
+@example(b"\1\0\0\5\6\7\x08", None, True, CobsVariant.ZPE)
+@example(b"\1\0\0\5\6\7\x08", None, False, CobsVariant.ZPE)
+def test_encode_gather_variant(libcobs: LibCobs, data, split, iterator, variant):
+    head, tail = 2, 0
+    if split is not None:
+        head = split.draw(st.integers(min_value=0, max_value=len(data)))
+        tail = split.draw(st.integers(min_value=0, max_value=len(data) - head))
+    elif len(data) < head + tail:
+        head, tail = 0, 0
+    encoded = libcobs.encode_gather(data, head, tail, iterator, variant)
+    assert encoded == libcobs.encode_variant(variant, data, False)
+
+
+@given(st.binary() | zero_heavy, st.sampled_from(CobsVariant))
+@example(b"\1" * 254 + b"\0", CobsVariant.COBS)
+@example(b"\1" * 223 + b"\0\0", CobsVariant.ZPE)
+@example(b"\1" * 30 + b"\0", CobsVariant.ZPE)
+@example(b"\1\xff", CobsVariant.COBSR)
+def test_encode_writer(libcobs: LibCobs, data, variant):
+    encoded = libcobs.encode_writer(variant, data)
+    assert encoded == libcobs.encode_variant(variant, data, False)
@@ -2,17 +2,20 @@
 
 #include "cobs.hpp"
 
-Cobs::Encoder * cobsEncoderNew(const uint8_t * src, size_t srcLen)
+#include <algorithm>
+#include <span>
+
+Cobs::Encoder<> * cobsEncoderNew(const uint8_t * src, size_t srcLen)
 {
-    return new Cobs::Encoder(std::span{src, srcLen});
+    return new Cobs::Encoder<>(std::span{src, srcLen});
 }
 
-void cobsEncoderDelete(Cobs::Encoder * state)
+void cobsEncoderDelete(Cobs::Encoder<> * state)
 {
     delete state;
 }
 
-size_t cobsEncode(Cobs::Encoder * state, uint8_t * dest, size_t destLen)
+size_t cobsEncode(Cobs::Encoder<> * state, uint8_t * dest, size_t destLen)
 {
     size_t index = 0;
     for (const auto byte : *state)
@@ -26,18 +29,156 @@ size_t cobsEncode(Cobs::Encoder * state, uint8_t * dest, size_t destLen)
     return index;
 }
 
-Cobs::Decoder * cobsDecoderNew()
+size_t cobsEncodeBulk(const uint8_t * src, size_t srcLen, uint8_t * dest, size_t destLen)
+{
+    return Cobs::encode(std::span{src, srcLen}, std::span{dest, destLen}).value_or(0);
+}
+
+template<Cobs::Variant V>
+static size_t encodeGather(
+    const uint8_t * src,
+    size_t srcLen,
+    size_t headLen,
+    size_t tailLen,
+    bool iterator,
+    uint8_t * dest,
+    size_t destLen)
+{
+    std::span in{src, srcLen};
+    const std::span<const uint8_t> parts[] = {
+        in.first(headLen),
+        in.subspan(headLen, srcLen - headLen - tailLen),
+        in.last(tailLen),
+    };
+    if (!iterator)
+    {
+        return Cobs::encode<V>(std::span{parts}, std::span{dest, destLen}).value_or(0);
+    }
+    size_t index = 0;
+    for (const auto byte : Cobs::Encoder<V>(std::span{parts}))
+    {
+        if (index == destLen)
+        {
+            break;
+        }
+        dest[index++] = byte;
+    }
+    return index;
+}
+
+size_t cobsEncodeGather(
+    Cobs::Variant variant,
+    const uint8_t * src,
+    size_t srcLen,
+    size_t headLen,
+    size_t tailLen,
+    bool iterator,
+    uint8_t * dest,
+    size_t destLen)
+{
+    switch (variant)
+    {
+    case Cobs::Variant::Cobs:
+        return encodeGather<Cobs::Variant::Cobs>(
+            src, srcLen, headLen, tailLen, iterator, dest, destLen);
+    case Cobs::Variant::CobsR:
+        return encodeGather<Cobs::Variant::CobsR>(
+            src, srcLen, headLen, tailLen, iterator, dest, destLen);
+    case Cobs::Variant::Zpe:
+        return encodeGather<Cobs::Variant::Zpe>(
+            src, srcLen, headLen, tailLen, iterator, dest, destLen);
+    }
+    return 0;
+}
+
+template<Cobs::Variant V>
+static size_t encodeVariant(
+    const uint8_t * src,
+    size_t srcLen,
+    bool iterator,
+    uint8_t * dest,
+    size_t destLen)
+{
+    if (!iterator)
+    {
+        return Cobs::encode<V>(std::span{src, srcLen}, std::span{dest, destLen}).value_or(0);
+    }
+    size_t index = 0;
+    for (const auto byte : Cobs::Encoder<V>(std::span{src, srcLen}))
+    {
+        if (index == destLen)
+        {
+            break;
+        }
+        dest[index++] = byte;
+    }
+    return index;
+}
+
+size_t cobsEncodeVariant(
+    Cobs::Variant variant,
+    const uint8_t * src,
+    size_t srcLen,
+    bool iterator,
+    uint8_t * dest,
+    size_t destLen)
 {
-    return new Cobs::Decoder();
+    switch (variant)
+    {
+    case Cobs::Variant::Cobs:
+        return encodeVariant<Cobs::Variant::Cobs>(src, srcLen, iterator, dest, destLen);
+    case Cobs::Variant::CobsR:
+        return encodeVariant<Cobs::Variant::CobsR>(src, srcLen, iterator, dest, destLen);
+    case Cobs::Variant::Zpe:
+        return encodeVariant<Cobs::Variant::Zpe>(src, srcLen, iterator, dest, destLen);
+    }
+    return 0;
 }
 
-void cobsDecoderDelete(Cobs::Decoder * state)
+template<Cobs::Variant V>
+static size_t encodeWriter(const uint8_t * src, size_t srcLen, uint8_t * dest, size_t destLen)
+{
+    if (destLen < Cobs::maxEncodedSize(srcLen, V))
+    {
+        return 0;
+    }
+    const auto out = [dest](size_t index) -> uint8_t & { return dest[index]; };
+    Cobs::Writer<V, decltype(out)> writer{out};
+    writer.push(std::span{src, srcLen});
+    return writer.finish();
+}
+
+size_t cobsEncodeWriter(
+    Cobs::Variant variant,
+    const uint8_t * src,
+    size_t srcLen,
+    uint8_t * dest,
+    size_t destLen)
+{
+    switch (variant)
+    {
+    case Cobs::Variant::Cobs:
+        return encodeWriter<Cobs::Variant::Cobs>(src, srcLen, dest, destLen);
+    case Cobs::Variant::CobsR:
+        return encodeWriter<Cobs::Variant::CobsR>(src, srcLen, dest, destLen);
+    case Cobs::Variant::Zpe:
+        return encodeWriter<Cobs::Variant::Zpe>(src, srcLen, dest, destLen);
+    }
+    return 0;
+}
+
+Cobs::Decoder<> * cobsDecoderNew()
+{
+    return new Cobs::Decoder<>();
+}
+
+void cobsDecoderDelete(Cobs::Decoder<> * state)
 {
     delete state;
 }
 
 size_t cobsDecode(
-    Cobs::Decoder * state,
+    Cobs::Decoder<> * state,
     const uint8_t * data,
     size_t dataLen,
     uint8_t * output,
@@ -50,11 +191,83 @@ size_t cobsDecode(
         {
             return index;
         }
-        const uint8_t byte = state->get(data[in]);
-        if (state->feed(data[in]))
+        state->feed(data[in], [&](uint8_t byte) { output[index++] = byte; });
+    }
+    return index;
+}
+
+size_t cobsDecodeChunked(
+    Cobs::Decoder<> * state,
+    const uint8_t * data,
+    size_t dataLen,
+    size_t chunkLen,
+    uint8_t * output,
+    size_t outputLen)
+{
+    std::span in{data, dataLen};
+    std::span out{output, outputLen};
+    size_t index = 0;
+    while (!in.empty())
+    {
+        const auto chunk = in.first(std::min(chunkLen, in.size()));
+        const auto result = state->decode(chunk, out.subspan(index));
+        in = in.subspan(result.consumed);
+        index += result.written;
+        if (result.frameEnd || result.consumed == 0)
         {
-            output[index++] = byte;
+            break;
         }
     }
     return index;
 }
+
+template<Cobs::Variant V>
+static size_t decodeVariant(
+    const uint8_t * data,
+    size_t dataLen,
+    bool bulk,
+    uint8_t * output,
+    size_t outputLen)
+{
+    Cobs::Decoder<V> state;
+    if (bulk)
+    {
+        return state.decode(std::span{data, dataLen}, std::span{output, outputLen}).written;
+    }
+    size_t index = 0;
+    for (size_t in = 0; in < dataLen; ++in)
+    {
+        const bool frameEnd = state.feed(data[in], [&](uint8_t byte)
+        {
+            if (index < outputLen)
+            {
+                output[index++] = byte;
+            }
+        });
+        if (frameEnd)
+        {
+            break;
+        }
+    }
+    return index;
+}
+
+size_t cobsDecodeVariant(
+    Cobs::Variant variant,
+    const uint8_t * data,
+    size_t dataLen,
+    bool bulk,
+    uint8_t * output,
+    size_t outputLen)
+{
+    switch (variant)
+    {
+    case Cobs::Variant::Cobs:
+        return decodeVariant<Cobs::Variant::Cobs>(data, dataLen, bulk, output, outputLen);
+    case Cobs::Variant::CobsR:
+        return decodeVariant<Cobs::Variant::CobsR>(data, dataLen, bulk, output, outputLen);
+    case Cobs::Variant::Zpe:
+        return decodeVariant<Cobs::Variant::Zpe>(data, dataLen, bulk, output, outputLen);
+    }
+    return 0;
+}
@@ -5,24 +5,57 @@
 #include <stddef.h>
 #include <stdint.h>
 
-namespace Cobs
-{
-    class Encoder;
-    class Decoder;
-}
-
 extern "C"
 {
-    Cobs::Encoder * cobsEncoderNew(const uint8_t * src, size_t srcLen);
-    void cobsEncoderDelete(Cobs::Encoder * state);
-    size_t cobsEncode(Cobs::Encoder * state, uint8_t * dest, size_t destLen);
+    Cobs::Encoder<> * cobsEncoderNew(const uint8_t * src, size_t srcLen);
+    void cobsEncoderDelete(Cobs::Encoder<> * state);
+    size_t cobsEncode(Cobs::Encoder<> * state, uint8_t * dest, size_t destLen);
+    size_t cobsEncodeBulk(const uint8_t * src, size_t srcLen, uint8_t * dest, size_t destLen);
+    size_t cobsEncodeGather(
+        Cobs::Variant variant,
+        const uint8_t * src,
+        size_t srcLen,
+        size_t headLen,
+        size_t tailLen,
+        bool iterator,
+        uint8_t * dest,
+        size_t destLen);
+
+    size_t cobsEncodeVariant(
+        Cobs::Variant variant,
+        const uint8_t * src,
+        size_t srcLen,
+        bool iterator,
+        uint8_t * dest,
+        size_t destLen);
 
-    Cobs::Decoder * cobsDecoderNew();
-    void cobsDecoderDelete(Cobs::Decoder * state);
+    size_t cobsEncodeWriter(
+        Cobs::Variant variant,
+        const uint8_t * src,
+        size_t srcLen,
+        uint8_t * dest,
+        size_t destLen);
+
+    Cobs::Decoder<> * cobsDecoderNew();
+    void cobsDecoderDelete(Cobs::Decoder<> * state);
     size_t cobsDecode(
-        Cobs::Decoder * state,
+        Cobs::Decoder<> * state,
+        const uint8_t * data,
+        size_t dataLen,
+        uint8_t * output,
+        size_t outputLen);
+    size_t cobsDecodeChunked(
+        Cobs::Decoder<> * state,
+        const uint8_t * data,
+        size_t dataLen,
+        size_t chunkLen,
+        uint8_t * output,
+        size_t outputLen);
+    size_t cobsDecodeVariant(
+        Cobs::Variant variant,
         const uint8_t * data,
         size_t dataLen,
+        bool bulk,
         uint8_t * output,
         size_t outputLen);
 }
@@ -1,6 +1,7 @@
 from __future__ import annotations
 
 from collections import deque
+from enum import IntEnum
 from ctypes import (
     CDLL,
     CFUNCTYPE,
@@ -11,6 +12,7 @@ from ctypes import (
     c_size_t,
     c_ubyte,
     c_uint32,
+    c_uint64,
     c_void_p,
     cast,
     cdll,
@@ -34,6 +36,8 @@ def pointerValue(pointer) -> int:
 def pytest_addoption(parser):
     parser.addoption("--libcobs", action="store", type=Path)
     parser.addoption("--libfnv1a", action="store", type=Path)
+    parser.addoption("--libchecksum", action="store", type=Path)
+    parser.addoption("--libdelta", action="store", type=Path)
 
 
 class StrStructure(Structure):
@@ -48,12 +52,25 @@ class StrStructure(Structure):
         )
 
 
+class CobsVariant(IntEnum):
+    "Mirror of `Cobs::Variant`"
+
+    COBS = 0
+    COBSR = 1
+    ZPE = 2
+
+
 class CobsEncoder(StrStructure):
     _fields_ = [
         ("data", c_bytes_p),
         ("size", c_size_t),
+        ("segments", c_void_p),
+        ("segmentsSize", c_size_t),
         ("runLength", c_ubyte),
         ("runIndex", c_ubyte),
+        ("header", c_ubyte),
+        ("skip", c_ubyte),
+        ("last", c_bool),
         ("runHeaderOutput", c_bool),
     ]
 
@@ -61,7 +78,9 @@ class CobsEncoder(StrStructure):
 class CobsDecoder(StrStructure):
     _fields_ = [
         ("runLength", c_ubyte),
-        ("remaining", c_bool),
+        ("zeros", c_ubyte),
+        ("header", c_ubyte),
+        ("frameTruncated", c_bool),
     ]
 
 
@@ -85,6 +104,44 @@ class LibCobs:
         self.lib.cobsEncode.restype = c_size_t
         self.cobsEncode = self.lib.cobsEncode
 
+        self.lib.cobsEncodeBulk.argtypes = [c_bytes_p, c_size_t, c_bytes_p, c_size_t]
+        self.lib.cobsEncodeBulk.restype = c_size_t
+        self.cobsEncodeBulk = self.lib.cobsEncodeBulk
+
+        self.lib.cobsEncodeGather.argtypes = [
+            c_ubyte,
+            c_bytes_p,
+            c_size_t,
+            c_size_t,
+            c_size_t,
+            c_bool,
+            c_bytes_p,
+            c_size_t,
+        ]
+        self.lib.cobsEncodeGather.restype = c_size_t
+        self.cobsEncodeGather = self.lib.cobsEncodeGather
+
+        self.lib.cobsEncodeVariant.argtypes = [
+            c_ubyte,
+            c_bytes_p,
+            c_size_t,
+            c_bool,
+            c_bytes_p,
+            c_size_t,
+        ]
+        self.lib.cobsEncodeVariant.restype = c_size_t
+        self.cobsEncodeVariant = self.lib.cobsEncodeVariant
+
+        self.lib.cobsEncodeWriter.argtypes = [
+            c_ubyte,
+            c_bytes_p,
+            c_size_t,
+            c_bytes_p,
+            c_size_t,
+        ]
+        self.lib.cobsEncodeWriter.restype = c_size_t
+        self.cobsEncodeWriter = self.lib.cobsEncodeWriter
+
         self.lib.cobsDecoderNew.argtypes = []
         self.lib.cobsDecoderNew.restype = CobsDecoder_p
         self.cobsDecoderNew = self.lib.cobsDecoderNew
@@ -103,6 +160,28 @@ class LibCobs:
         self.lib.cobsDecode.restype = c_size_t
         self.cobsDecode = self.lib.cobsDecode
 
+        self.lib.cobsDecodeChunked.argtypes = [
+            CobsDecoder_p,
+            c_bytes_p,
+            c_size_t,
+            c_size_t,
+            c_bytes_p,
+            c_size_t,
+        ]
+        self.lib.cobsDecodeChunked.restype = c_size_t
+        self.cobsDecodeChunked = self.lib.cobsDecodeChunked
+
+        self.lib.cobsDecodeVariant.argtypes = [
+            c_ubyte,
+            c_bytes_p,
+            c_size_t,
+            c_bool,
+            c_bytes_p,
+            c_size_t,
+        ]
+        self.lib.cobsDecodeVariant.restype = c_size_t
+        self.cobsDecodeVariant = self.lib.cobsDecodeVariant
+
     def encode(self, data: bytes) -> bytes:
         state = self.cobsEncoderNew(data, len(data))
         out_len = cobs.max_encoded_length(len(data))
@@ -113,6 +192,45 @@ class LibCobs:
             self.cobsEncoderDelete(state)
         return buf.raw[:enc_len]
 
+    def encode_bulk(self, data: bytes) -> bytes:
+        out_len = cobs.max_encoded_length(len(data))
+        buf = create_string_buffer(out_len)
+        enc_len = self.cobsEncodeBulk(data, len(data), buf, len(buf))
+        return buf.raw[:enc_len]
+
+    def encode_gather(
+        self,
+        data: bytes,
+        head: int,
+        tail: int,
+        iterator: bool,
+        variant: CobsVariant = CobsVariant.COBS,
+    ) -> bytes:
+        # COBS/ZPE has shorter maximum runs, so it can be bigger than COBS
+        out_len = len(data) + len(data) // 223 + 1
+        buf = create_string_buffer(out_len)
+        enc_len = self.cobsEncodeGather(
+            variant, data, len(data), head, tail, iterator, buf, len(buf)
+        )
+        return buf.raw[:enc_len]
+
+    def encode_variant(
+        self, variant: CobsVariant, data: bytes, iterator: bool
+    ) -> bytes:
+        # COBS/ZPE has shorter maximum runs, so it can be bigger than COBS
+        out_len = len(data) + len(data) // 223 + 1
+        buf = create_string_buffer(out_len)
+        enc_len = self.cobsEncodeVariant(
+            variant, data, len(data), iterator, buf, len(buf)
+        )
+        return buf.raw[:enc_len]
+
+    def encode_writer(self, variant: CobsVariant, data: bytes) -> bytes:
+        out_len = len(data) + len(data) // 223 + 1
+        buf = create_string_buffer(out_len)
+        enc_len = self.cobsEncodeWriter(variant, data, len(data), buf, len(buf))
+        return buf.raw[:enc_len]
+
     def decode(self, data: bytes) -> bytes:
         out_len = len(data)
         buf = create_string_buffer(out_len)
@@ -123,6 +241,35 @@ class LibCobs:
             self.cobsDecoderDelete(state)
         return buf.raw[:dec_len]
 
+    def decode_chunked(self, data: bytes, chunk: int) -> bytes:
+        out_len = len(data)
+        buf = create_string_buffer(out_len)
+        state = self.cobsDecoderNew()
+        try:
+            dec_len = self.cobsDecodeChunked(
+                state, data, len(data), chunk, buf, len(buf)
+            )
+        finally:
+            self.cobsDecoderDelete(state)
+        return buf.raw[:dec_len]
+
+    def decode_truncated(self, data: bytes, chunk: int) -> bool:
+        "Whether the decoder found `data` to be truncated"
+        buf = create_string_buffer(len(data))
+        state = self.cobsDecoderNew()
+        try:
+            self.cobsDecodeChunked(state, data, len(data), chunk, buf, len(buf))
+            return state.contents.frameTruncated
+        finally:
+            self.cobsDecoderDelete(state)
+
+    def decode_variant(self, variant: CobsVariant, data: bytes, bulk: bool) -> bytes:
+        # COBS/ZPE can decode a header to two zeros
+        out_len = 2 * len(data)
+        buf = create_string_buffer(out_len)
+        dec_len = self.cobsDecodeVariant(variant, data, len(data), bulk, buf, len(buf))
+        return buf.raw[:dec_len]
+
 
 @pytest.fixture(scope="session")
 def libcobs(request):
@@ -140,11 +287,18 @@ class LibFnv1a:
         self.lib.fnv1aHash.restype = c_uint32
         self.fnv1aHash = self.lib.fnv1aHash
 
+        self.lib.fnv1aCheck.argtypes = [c_bytes_p, c_size_t]
+        self.lib.fnv1aCheck.restype = c_bool
+        self.fnv1aCheck = self.lib.fnv1aCheck
+
     def hash(self, data: bytes) -> int:
         out_len = len(data)
         state = self.fnv1aHash(data, len(data))
         return state
 
+    def check(self, data: bytes) -> bool:
+        return self.fnv1aCheck(data, len(data))
+
 
 @pytest.fixture(scope="session")
 def libfnv1a(request):
@@ -152,3 +306,93 @@ def libfnv1a(request):
     if not opt:
         pytest.skip()
     return LibFnv1a(opt)
+
+
+class ChecksumKind(IntEnum):
+    "Mirror of `Checksum::Kind`"
+
+    FNV1A = 0
+    CRC32C = 1
+    CRC32C_HW = 2
+    CRC16 = 3
+    NONE = 4
+
+
+class LibChecksum:
+    def __init__(self, lib_path: Path):
+        self.lib = cdll.LoadLibrary(str(lib_path))
+
+        self.lib.checksumCompute.argtypes = [c_ubyte, c_bytes_p, c_size_t, c_bool]
+        self.lib.checksumCompute.restype = c_uint32
+        self.checksumCompute = self.lib.checksumCompute
+
+        self.lib.checksumCheck.argtypes = [c_ubyte, c_bytes_p, c_size_t]
+        self.lib.checksumCheck.restype = c_bool
+        self.checksumCheck = self.lib.checksumCheck
+
+    def compute(self, kind: ChecksumKind, data: bytes, bulk: bool = True) -> int:
+        return self.checksumCompute(kind, data, len(data), bulk)
+
+    def check(self, kind: ChecksumKind, data: bytes) -> bool:
+        return self.checksumCheck(kind, data, len(data))
+
+
+@pytest.fixture(scope="session")
+def libchecksum(request):
+    opt = request.config.getoption("--libchecksum")
+    if not opt:
+        pytest.skip()
+    return LibChecksum(opt)
+
+
+class LibDelta:
+    def __init__(self, lib_path: Path):
+        self.lib = cdll.LoadLibrary(str(lib_path))
+
+        self.lib.deltaEncode.argtypes = [
+            c_bool,
+            POINTER(c_uint64),
+            c_size_t,
+            c_bytes_p,
+            c_size_t,
+        ]
+        self.lib.deltaEncode.restype = c_size_t
+        self.deltaEncode = self.lib.deltaEncode
+
+        self.lib.deltaDecode.argtypes = [
+            c_bool,
+            c_bytes_p,
+            c_size_t,
+            POINTER(c_uint64),
+            c_size_t,
+        ]
+        self.lib.deltaDecode.restype = c_size_t
+        self.deltaDecode = self.lib.deltaDecode
+
+    def encode(self, signed: bool, values: list[int]) -> bytes:
+        "The tagged CBOR encoding of `values` as `Cbor::Deltas`."
+        array = (c_uint64 * len(values))(*(value & 0xFFFFFFFFFFFFFFFF for value in values))
+        # Tag, byte string header and at most 10 bytes per value
+        buf = create_string_buffer(3 + 9 + 10 * len(values))
+        enc_len = self.deltaEncode(signed, array, len(values), buf, len(buf))
+        return buf.raw[:enc_len]
+
+    def decode(self, signed: bool, data: bytes) -> list[int] | None:
+        "Inverse of `encode`, `None` if the C++ decoder rejects it."
+        count = len(data)
+        array = (c_uint64 * count)()
+        dec_len = self.deltaDecode(signed, data, len(data), array, count)
+        if dec_len == 2**64 - 1:
+            return None
+        values = list(array[:dec_len])
+        if signed:
+            values = [v - 2**64 if v >= 2**63 else v for v in values]
+        return values
+
+
+@pytest.fixture(scope="session")
+def libdelta(request):
+    opt = request.config.getoption("--libdelta")
+    if not opt:
+        pytest.skip()
+    return LibDelta(opt)
@@ -0,0 +1,60 @@
+import sys
+from pathlib import Path
+
+import cbor2
+import pytest
+from conftest import LibDelta
+from hypothesis import example, given
+from hypothesis import strategies as st
+
+# The host side mirror, without installing the Python package
+sys.path.insert(0, str(Path(__file__).parent.parent / "python"))
+from comms_ccf import delta  # noqa: E402
+
+INT64_MIN = -(2**63)
+INT64_MAX = 2**63 - 1
+UINT64_MAX = 2**64 - 1
+
+int64s = st.integers(min_value=INT64_MIN, max_value=INT64_MAX)
+uint64s = st.integers(min_value=0, max_value=UINT64_MAX)
+# Mostly the extremes, where the differences wrap
+extremes = st.sampled_from([INT64_MIN, INT64_MIN + 1, -1, 0, 1, INT64_MAX])
+big = st.sampled_from([0, 1, 2**63 - 1, 2**63, UINT64_MAX])
+
+
+def contents(encoded: bytes) -> bytes:
+    "The varints of a tagged delta sequence."
+    tag = cbor2.loads(encoded)
+    assert isinstance(tag, cbor2.CBORTag) and tag.tag == delta.TAG
+    return tag.value
+
+
+@given(st.lists(int64s | extremes))
+@example([INT64_MIN, INT64_MAX])
+@example([INT64_MAX, INT64_MIN, 0, -1, INT64_MAX])
+def test_signed(libdelta: LibDelta, values):
+    encoded = contents(libdelta.encode(True, values))
+    assert delta.decode(encoded) == values
+    assert delta.encode(values) == encoded
+    assert libdelta.decode(True, cbor2.dumps(cbor2.CBORTag(delta.TAG, encoded))) == values
+
+
+@given(st.lists(uint64s | big))
+@example([2**63])
+@example([UINT64_MAX, 0])
+def test_unsigned(libdelta: LibDelta, values):
+    encoded = contents(libdelta.encode(False, values))
+    assert delta.decode(encoded, signed=False) == values
+    # As the RPC client does with the `UNSIGNED_HINT`
+    assert delta.decode(encoded).unsigned() == values
+    assert delta.encode(values) == encoded
+    assert libdelta.decode(False, cbor2.dumps(cbor2.CBORTag(delta.TAG, encoded))) == values
+
+
+def test_too_wide(libdelta: LibDelta):
+    "A delta of 65 bits isn't valid for either side."
+    encoded = b"\x80" * 9 + b"\x02"
+    tagged = cbor2.dumps(cbor2.CBORTag(delta.TAG, encoded))
+    assert libdelta.decode(True, tagged) is None
+    with pytest.raises(ValueError):
+        delta.decode(encoded)
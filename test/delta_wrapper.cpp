@@ -0,0 +1,52 @@
+#include "delta_wrapper.hpp"
+
+#include "cbor.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <span>
+#include <vector>
+
+template<typename I>
+static size_t encode(const uint64_t * values, size_t count, uint8_t * dest, size_t destLen)
+{
+    std::vector<I> converted(values, values + count);
+    std::span<uint8_t> out{dest, destLen};
+    if (!Cbor::Cbor<Cbor::Deltas<I>>::encode({converted}, out))
+    {
+        return 0;
+    }
+    return destLen - out.size();
+}
+
+template<typename I>
+static size_t decode(const uint8_t * data, size_t dataLen, uint64_t * values, size_t count)
+{
+    std::vector<uint8_t> copy(data, data + dataLen);
+    std::span<uint8_t> in{copy};
+    const auto view = Cbor::Cbor<Cbor::DeltaView<I>>::decode(in);
+    if (!view || !in.empty() || view->size() > count)
+    {
+        return SIZE_MAX;
+    }
+    std::ranges::copy(*view, values);
+    return view->size();
+}
+
+size_t deltaEncode(
+    bool isSigned, const uint64_t * values, size_t count, uint8_t * dest, size_t destLen)
+{
+    return isSigned
+        ? encode<int64_t>(values, count, dest, destLen)
+        : encode<uint64_t>(values, count, dest, destLen);
+}
+
+size_t deltaDecode(
+    bool isSigned, const uint8_t * data, size_t dataLen, uint64_t * values, size_t count)
+{
+    return isSigned
+        ? decode<int64_t>(data, dataLen, values, count)
+        : decode<uint64_t>(data, dataLen, values, count);
+}
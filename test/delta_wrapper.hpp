@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+extern "C"
+{
+    /// Encodes `values` as `Cbor::Deltas` of `int64_t` (or `uint64_t` if
+    /// not `isSigned`), tag and all, returning the size or 0 on failure.
+    size_t deltaEncode(
+        bool isSigned, const uint64_t * values, size_t count, uint8_t * dest, size_t destLen);
+    /// Decodes the tagged `Cbor::DeltaView` at `data` into `values`,
+    /// returning how many or SIZE_MAX if it is invalid.
+    size_t deltaDecode(
+        bool isSigned, const uint8_t * data, size_t dataLen, uint64_t * values, size_t count);
+}
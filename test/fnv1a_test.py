@@ -9,3 +9,14 @@ from conftest import LibFnv1a
 def test_encode(libfnv1a: LibFnv1a, data):
     encoded = libfnv1a.hash(data)
     assert encoded == fnv1a_32(data)
+
+
+@pytest.mark.parametrize(
+    argnames="data",
+    argvalues=[b"", b"1234", bytes(range(255))]
+)
+def test_check(libfnv1a: LibFnv1a, data):
+    framed = data + fnv1a_32(data).to_bytes(length=4, byteorder="little")
+    assert libfnv1a.check(framed)
+    assert not libfnv1a.check(framed[:-1])
+    assert not libfnv1a.check(bytes([framed[0] ^ 1]) + framed[1:])
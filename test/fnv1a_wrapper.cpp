@@ -1,5 +1,6 @@
 #include "fnv1a_wrapper.hpp"
 
+#include "checksum.hpp"
 #include "fnv1a.hpp"
 
 #include <stddef.h>
@@ -10,3 +11,13 @@ uint32_t fnv1aHash(const uint8_t * buf, size_t len)
 {
     return Fnv1a::checksum(std::span{std::remove_const_t<uint8_t *>(buf), len});
 }
+
+bool fnv1aCheck(const uint8_t * buf, size_t len)
+{
+    Checksum::Checker<Checksum::Kind::Fnv1a> checker;
+    for (size_t i = 0; i < len; ++i)
+    {
+        checker.feed(buf[i]);
+    }
+    return checker.check();
+}
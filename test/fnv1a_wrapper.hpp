@@ -7,4 +7,5 @@
 extern "C"
 {
     uint32_t fnv1aHash(const uint8_t * data, size_t len);
+    bool fnv1aCheck(const uint8_t * data, size_t len);
 }
@@ -6,28 +6,78 @@
 #include <stdio.h>
 #include <termios.h>
 
+#include <algorithm>
 #include <array>
 #include <iterator>
+#include <ranges>
+#include <span>
 #include <string_view>
 
 using namespace std::literals;
 
+#if !defined(CCF_FRAMING)
+#define CCF_FRAMING Cobs
+#endif
+
+#if !defined(CCF_CHECKSUM)
+#define CCF_CHECKSUM Fnv1a
+#endif
+
 // Just an illustration of where the semaphore/notification should be used
 static bool notification = false;
 
 static Ccf<{
-    .rxBufSize = 256,
-    .txBufSize = 256,
-    .maxPktSize = 255,
+    .rxBufSize = 2048,
+    .txBufSize = 2048,
+    .maxPktSize = 1024,
+    .framing = Cobs::Variant::CCF_FRAMING,
+    .checksum = Checksum::Kind::CCF_CHECKSUM,
 }> ccf;
 
+struct Point
+{
+    int x;
+    int y;
+};
+
+struct Status
+{
+    unsigned uptime;
+    int temperature;
+    bool ok;
+    std::string_view name;
+    Point position;
+};
+
+/// Encoded as a map, so clients can leave out fields
+struct Config
+{
+    unsigned rate = 100;
+    bool enabled = false;
+    std::array<int, 2> limits = {-10, 10};
+};
+namespace Cbor { template<> constexpr bool aggregateAsMap<Config> = true; }
+
 static std::array<uint8_t, 30> scratchLogBuf;
+static std::array<uint16_t, 64> samplesBuf;
+static std::array<uint32_t, 64> timestampsBuf;
+static std::array<uint8_t, 1000> patternBuf;
 static std::span<uint8_t> scratchLogSpan{scratchLogBuf};
 
-Rpc rpc
+RPC_CONSTINIT Rpc rpc
 {
     Call{"add", "return x+y", {"x", "y"}, +[](int x, int y) { return x + y; }},
     Call{"hello", "greet the world", {}, +[](){ return "Hello, world!"sv; }},
+    Call{"pattern", "return size bytes counting up (mod 256)", {"size"},
+    +[](size_t size)
+    {
+        size = std::min(size, patternBuf.size());
+        for (size_t i = 0; i < size; ++i)
+        {
+            patternBuf[i] = static_cast<uint8_t>(i);
+        }
+        return std::span{patternBuf}.first(size);
+    }},
     Call{"log_delayed", "test log", {},
     +[]()
     {
@@ -38,6 +88,78 @@ Rpc rpc
     {
         ccf.log(LogLevel::Info, 1, "Test %d %f %s", 1, 2.0, "3");
     }},
+    Call{"lengths", "return the lengths of a string and two byte strings", {"s", "a", "b"},
+    +[](std::string_view s, std::span<uint8_t> a, std::span<uint8_t> b)
+    {
+        return std::tuple{s.size(), a.size(), b.size()};
+    }},
+    Call{"sum", "add up a list of numbers", {"xs"},
+    +[](Cbor::ArrayView<int> xs)
+    {
+        int total = 0;
+        for (int x : xs)
+        {
+            total += x;
+        }
+        return total;
+    }},
+    Call{"evens", "the even numbers of a list, in order", {"xs"},
+    +[](Cbor::ArrayView<int> xs)
+    {
+        return xs | std::views::filter([](int x) { return x % 2 == 0; });
+    }},
+    Call{"squares", "the squares of 0 to n-1", {"n"},
+    +[](unsigned n)
+    {
+        return std::views::iota(0u, n) | std::views::transform([](unsigned x) { return x * x; });
+    }},
+    Call{"status", "an example struct", {},
+    +[]() { return Status{.uptime = 42, .temperature = -5, .ok = true, .name = "demo", .position = {3, 4}}; }},
+    Call{"move", "move a point by dx and dy", {"point", "dx", "dy"},
+    +[](Point point, int dx, int dy) { return Point{point.x + dx, point.y + dy}; }},
+    Call{"configure", "return the config, with defaults for missing fields", {"config"},
+    +[](Config config) { return config; }},
+    Call{"samples", "n example samples, as a typed array", {"n"},
+    +[](size_t n)
+    {
+        n = std::min(n, samplesBuf.size());
+        for (size_t i = 0; i < n; ++i)
+        {
+            samplesBuf[i] = static_cast<uint16_t>(100 * i);
+        }
+        return Cbor::TypedArray<uint16_t>{std::span<const uint16_t>{samplesBuf.data(), n}};
+    }},
+    Call{"total", "add up a typed array", {"xs"},
+    +[](Cbor::TypedArray<int16_t> xs)
+    {
+        int total = 0;
+        for (int x : xs)
+        {
+            total += x;
+        }
+        return total;
+    }},
+    Call{"timestamps", "n example timestamps, delta encoded", {"n"},
+    +[](size_t n)
+    {
+        n = std::min(n, timestampsBuf.size());
+        for (size_t i = 0; i < n; ++i)
+        {
+            // About a millisecond apart, with some jitter
+            timestampsBuf[i] = static_cast<uint32_t>(1000000 + 1000 * i + i % 3);
+        }
+        return Cbor::Deltas<uint32_t>{std::span<const uint32_t>{timestampsBuf.data(), n}};
+    }},
+    Call{"last", "the length and last value of a delta encoded sequence", {"xs"},
+    +[](Cbor::DeltaView<int> xs)
+    {
+        int last = 0;
+        for (int x : xs)
+        {
+            last = x;
+        }
+        return std::tuple{xs.size(), last};
+    }},
 };
 
 static void rxIsr(uint8_t byte)